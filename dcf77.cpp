@@ -19,6 +19,12 @@
 #include "dcf77.h"
 
 namespace Internal { namespace Debug {
+    Print *output = &Serial;
+
+    void set_output(Print &new_output) {
+        output = &new_output;
+    }
+
     void debug_helper(char data) { sprint(data == 0? 'S': data == 1? '?': data - 2 + '0', 0); }
 
     void bcddigit(uint8_t data) {
@@ -57,6 +63,108 @@ namespace Internal { namespace Debug {
     }
 }}
 
+namespace Internal { namespace Telemetry {
+    uint32_t zigzag(const int32_t value) {
+        return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    }
+
+    int32_t unzigzag(const uint32_t value) {
+        return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+    }
+
+    uint8_t varint_length(uint32_t value) {
+        uint8_t length = 1;
+        while (value >= 0x80) {
+            value >>= 7;
+            ++length;
+        }
+        return length;
+    }
+
+    void checksum_add(uint8_t &sum_1, uint8_t &sum_2, const uint8_t data) {
+        // Fletcher-16, modulo 255 without division
+        uint16_t sum = (uint16_t)sum_1 + data;
+        sum_1 = sum >= 255? sum - 255: sum;
+        sum = (uint16_t)sum_2 + sum_1;
+        sum_2 = sum >= 255? sum - 255: sum;
+    }
+
+    void Encoder::begin(const byte_sink_t sink, const uint8_t frame_type, const uint16_t payload_length) {
+        this->sink = sink;
+        sum_1 = 0;
+        sum_2 = 0;
+
+        sink(start_byte);
+        put(frame_type);
+        put_16(payload_length);
+    }
+
+    void Encoder::put(const uint8_t data) {
+        checksum_add(sum_1, sum_2, data);
+        sink(data);
+    }
+
+    void Encoder::put_16(const uint16_t data) {
+        put(data);
+        put(data >> 8);
+    }
+
+    void Encoder::put_32(const uint32_t data) {
+        put_16(data);
+        put_16(data >> 16);
+    }
+
+    void Encoder::put_varint(uint32_t data) {
+        while (data >= 0x80) {
+            put((data & 0x7f) | 0x80);
+            data >>= 7;
+        }
+        put(data);
+    }
+
+    void Encoder::end() {
+        sink(sum_1);
+        sink(sum_2);
+    }
+
+    void Reader::setup(const uint8_t *data, const uint16_t length) {
+        this->data = data;
+        this->length = length;
+        position = 0;
+        ok = true;
+    }
+
+    uint8_t Reader::get() {
+        if (position < length) {
+            return data[position++];
+        }
+        ok = false;
+        return 0;
+    }
+
+    uint16_t Reader::get_16() {
+        const uint16_t lo = get();
+        return lo | (uint16_t)get() << 8;
+    }
+
+    uint32_t Reader::get_32() {
+        const uint32_t lo = get_16();
+        return lo | (uint32_t)get_16() << 16;
+    }
+
+    uint32_t Reader::get_varint() {
+        uint32_t value = 0;
+        for (uint8_t shift = 0; shift < 35; shift += 7) {
+            const uint8_t data = get();
+            value |= (uint32_t)(data & 0x7f) << shift;
+            if (!(data & 0x80)) {
+                break;
+            }
+        }
+        return value;
+    }
+}}
+
 namespace BCD {
     void print(const bcd_t value) {
         sprint(value.val >> 4 & 0xF, HEX);
@@ -320,6 +428,16 @@ namespace Internal { // DCF77_Year_Decoder
         return year;
     }
 
+    void DCF77_Year_Decoder::set_fast_path(const bool enabled) {
+        Binning::Decoder<uint8_t, 10>::set_fast_path(enabled);
+        Decade_Decoder.set_fast_path(enabled);
+    }
+
+    void DCF77_Year_Decoder::set_annealed(const bool enabled) {
+        Binning::Decoder<uint8_t, 10>::set_annealed(enabled);
+        Decade_Decoder.set_annealed(enabled);
+    }
+
     void DCF77_Year_Decoder::setup() {
         Binning::Decoder<uint8_t, 10>::setup();
         Decade_Decoder.setup();
@@ -701,6 +819,21 @@ namespace Internal {  // DCF77_Second_Decoder
         }
     }
 
+    void DCF77_Second_Decoder::align(const uint8_t second) {
+        // inverse of get_time_value()
+        if (signal_max_index < seconds_per_minute && second < seconds_per_minute) {
+            tick = (second + 2 + signal_max_index) % seconds_per_minute;
+        }
+    }
+
+    void DCF77_Second_Decoder::seed(const uint8_t second, const uint8_t weight) {
+        // adds weight to the bin that makes get_time_value() return second
+        if (second < seconds_per_minute) {
+            Arithmetic_Tools::bounded_add(data[(2*seconds_per_minute + tick - 2 - second) % seconds_per_minute], weight);
+            compute_max_index();
+        }
+    }
+
     void DCF77_Second_Decoder::debug() {
         static uint8_t prev_tick;
 
@@ -1373,36 +1506,160 @@ namespace Internal {
                 case 57: now.year.val += 0x80*naive_value; break;
             }
         }
+
+        void Frame_Decoder::setup() {
+            second = 60;
+            valid = false;
+            parity = 0;
+        }
+
+        bool is_bcd(const BCD::bcd_t value, const uint8_t min, const uint8_t max) {
+            return value.digit.lo <= 9 && value.val >= min && value.val <= max;
+        }
+
+        bool Frame_Decoder::process_tick(const uint8_t tick_data) {
+            if (tick_data == sync_mark) {
+                // the frame is complete with the sync mark
+                const bool complete = valid && second == 59;
+                second = 0;
+                valid = true;
+                parity = 0;
+                return complete;
+            }
+            if (second > 58) {
+                // lost track of the minute or leap second
+                valid = false;
+                return false;
+            }
+
+            const uint8_t bit = tick_data == long_tick;
+            // start of minute is always 0, the weather bits 1..14 are not decoded
+            valid = valid && (second == 0? tick_data == short_tick:
+                              second < 15 || tick_data == long_tick || tick_data == short_tick);
+
+            switch (second) {
+                // start of time is always 1
+                case 20: valid = valid && bit; break;
+
+                // even parity over 21..28, 29..35 and 36..58
+                case 28: case 35: case 58:
+                    valid = valid && parity == bit;
+                    parity = 0;
+                    break;
+
+                default:
+                    parity ^= (second > 20) && bit;
+            }
+
+            if (valid) {
+                set_bit(second, tick_data, frame);
+            }
+
+            if (valid && second == 58) {
+                BCD::bcd_t weekday;
+
+                valid = is_bcd(frame.minute,  0x00, 0x59) &&
+                        is_bcd(frame.hour,    0x00, 0x23) &&
+                        is_bcd(frame.weekday, 0x01, 0x07) &&
+                        is_bcd(frame.month,   0x01, 0x12) &&
+                        is_bcd(frame.year,    0x00, 0x99) &&
+                        is_bcd(frame.day,     0x01, 0x31) &&
+                        BCD::bcd_to_int(frame.day) <= frame.days_per_month();
+
+                if (valid) {
+                    weekday = frame.get_bcd_weekday();
+                    if (weekday.val == 0) {
+                        weekday.val = 7;
+                    }
+                    valid = weekday.val == frame.weekday.val;
+                }
+            }
+            ++second;
+            return false;
+        }
     }
 }
 
-namespace Internal {  // DCF77_Clock_Controller<Configuration, Frequency_Control>
-    // static member definitions for DCF77_Clock_Controller<Configuration, Frequency_Control>
-    template <typename Configuration, typename Frequency_Control> Clock::output_handler_t DCF77_Clock_Controller<Configuration, Frequency_Control>::output_handler = 0;
+namespace Internal {  // DCF77_Callback_Monitor
+    DCF77_Callback_Monitor::sample_handler_t             DCF77_Callback_Monitor::sample_handler = 0;
+    DCF77_Callback_Monitor::bin_average_handler_t        DCF77_Callback_Monitor::bin_average_handler = 0;
+    DCF77_Callback_Monitor::tick_decision_handler_t      DCF77_Callback_Monitor::tick_decision_handler = 0;
+    DCF77_Callback_Monitor::second_tick_handler_t        DCF77_Callback_Monitor::second_tick_handler = 0;
+    DCF77_Callback_Monitor::clock_state_change_handler_t DCF77_Callback_Monitor::clock_state_change_handler = 0;
+}
 
-    template <typename Configuration, typename Frequency_Control> DCF77_Second_Decoder  DCF77_Clock_Controller<Configuration, Frequency_Control>::Second_Decoder;
-    template <typename Configuration, typename Frequency_Control> DCF77_Minute_Decoder  DCF77_Clock_Controller<Configuration, Frequency_Control>::Minute_Decoder;
-    template <typename Configuration, typename Frequency_Control> DCF77_Hour_Decoder    DCF77_Clock_Controller<Configuration, Frequency_Control>::Hour_Decoder;
-    template <typename Configuration, typename Frequency_Control> DCF77_Weekday_Decoder DCF77_Clock_Controller<Configuration, Frequency_Control>::Weekday_Decoder;
-    template <typename Configuration, typename Frequency_Control> DCF77_Day_Decoder     DCF77_Clock_Controller<Configuration, Frequency_Control>::Day_Decoder;
-    template <typename Configuration, typename Frequency_Control> DCF77_Month_Decoder   DCF77_Clock_Controller<Configuration, Frequency_Control>::Month_Decoder;
-    template <typename Configuration, typename Frequency_Control> DCF77_Year_Decoder    DCF77_Clock_Controller<Configuration, Frequency_Control>::Year_Decoder;
-    template <typename Configuration, typename Frequency_Control> DCF77_Flag_Decoder    DCF77_Clock_Controller<Configuration, Frequency_Control>::Flag_Decoder;
+namespace Internal {  // DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>
+    // static member definitions for DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>
+    template <typename Configuration, typename Frequency_Control, typename Monitor> Clock::output_handler_t DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::output_handler = 0;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> Clock::deferred_output_handler_t DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::deferred_output_handler = 0;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> Clock::time_t DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::output_mailbox;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> volatile bool DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::output_pending = false;
+
+    template <typename Configuration, typename Frequency_Control, typename Monitor> DCF77_Second_Decoder  DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::Second_Decoder;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> typename DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::minute_decoder_t
+        DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::Minute_Decoder;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> typename DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::hour_decoder_t
+        DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::Hour_Decoder;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> DCF77_Weekday_Decoder DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::Weekday_Decoder;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> DCF77_Day_Decoder     DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::Day_Decoder;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> DCF77_Month_Decoder   DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::Month_Decoder;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> DCF77_Year_Decoder    DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::Year_Decoder;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> DCF77_Flag_Decoder    DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::Flag_Decoder;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> DCF77_Naive_Bitstream_Decoder::Frame_Decoder DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::Frame_Decoder;
+
+    template <typename Configuration, typename Frequency_Control, typename Monitor> uint8_t       DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::leap_second;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> DCF77_Encoder DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::decoded_time;
+
+    template <typename Configuration, typename Frequency_Control, typename Monitor> typename DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::clock_diagnostics_t
+        DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::diagnostics[2];
+    template <typename Configuration, typename Frequency_Control, typename Monitor> volatile uint8_t DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::diagnostics_generation = 0;
+
+    template <typename Configuration, typename Frequency_Control, typename Monitor> volatile typename DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::clock_statistics_t
+        DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::statistics;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> uint16_t DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::statistics_ms = 0;
+
+    template <typename Configuration, typename Frequency_Control, typename Monitor> Trace_Recorder<Configuration::trace_length>
+        DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::Trace;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> Tick_History<Configuration::tick_history_minutes>
+        DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::History;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> uint16_t DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::replay_pending = 0;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> DCF77_Encoder DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::replay_frame;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> bool DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::replay_frame_pending = false;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> uint16_t DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::replay_frame_age = 0;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> bool DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::decoders_frozen = false;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> bool DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::carrier_absent = true;
+
+    template <typename Configuration, typename Frequency_Control, typename Monitor> DCF77_Encoder
+        DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::restored_time;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> uint8_t DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::restore_delay = 0;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> typename DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::restore_state_t
+        DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::restore_state = DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::restore_idle;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> DCF77_Encoder
+        DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::hint_time;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> uint8_t DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::hint_pending = 0;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> uint8_t DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::hint_minutes = 0;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> uint8_t DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::joint_date_quality_factor = 0;
 
-    template <typename Configuration, typename Frequency_Control> uint8_t       DCF77_Clock_Controller<Configuration, Frequency_Control>::leap_second;
-    template <typename Configuration, typename Frequency_Control> DCF77_Encoder DCF77_Clock_Controller<Configuration, Frequency_Control>::decoded_time;
+    #if defined(_AVR_EEPROM_H_)
+    template <typename Configuration, typename Frequency_Control, typename Monitor> uint32_t DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::last_snapshot_uptime = 0;
+    #endif
 
-    template <typename Configuration, typename Frequency_Control> DCF77_Local_Clock<DCF77_Clock_Controller<Configuration, Frequency_Control> >
-        DCF77_Clock_Controller<Configuration, Frequency_Control>::Local_Clock;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> DCF77_Local_Clock<DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor> >
+        DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::Local_Clock;
 
-    template <typename Configuration, typename Frequency_Control> DCF77_Demodulator<DCF77_Clock_Controller<Configuration, Frequency_Control> >
-        DCF77_Clock_Controller<Configuration, Frequency_Control>::Demodulator;
+    template <typename Configuration, typename Frequency_Control, typename Monitor> DCF77_Demodulator<DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor> >
+        DCF77_Clock_Controller<Configuration, Frequency_Control, Monitor>::Demodulator;
+
+    // The static members are defined here only, thus controllers other than
+    // the one of DCF77_Clock must be instantiated explicitly. This one is
+    // used by the unit test.
+    template struct DCF77_Clock_Controller<Configuration, DCF77_No_Frequency_Control>;
 }
 
 namespace DCF77_Clock {
     using namespace Internal;
 
-    typedef DCF77_Clock_Controller<Configuration, DCF77_Frequency_Control> Clock_Controller;
+    typedef DCF77_Clock_Controller<Configuration, DCF77_Frequency_Control, DCF77_Clock_Monitor> Clock_Controller;
 
     void setup() {
         Clock_Controller::setup();
@@ -1426,10 +1683,22 @@ namespace DCF77_Clock {
         Clock_Controller::set_output_handler(output_handler);
     }
 
+    void set_deferred_output_handler(const Clock::deferred_output_handler_t output_handler) {
+        Clock_Controller::set_deferred_output_handler(output_handler);
+    }
+
+    bool dispatch_output() {
+        return Clock_Controller::dispatch_output();
+    }
+
     #if defined(__AVR__)
     void auto_persist() {
         Clock_Controller::auto_persist();
     }
+
+    bool restore_state(const uint32_t age_seconds) {
+        return Clock_Controller::restore_snapshot_from_eeprom(age_seconds);
+    }
     #endif
 
     void convert_time(const DCF77_Encoder &current_time, Clock::time_t &now) {
@@ -1467,6 +1736,28 @@ namespace DCF77_Clock {
         convert_time(current_time, now_plus_1s);
     }
 
+    void set_time_hint(const Clock::time_t &time, const uint32_t uncertainty_seconds) {
+        DCF77_Encoder hint;
+        hint.reset();
+        hint.second                    = BCD::bcd_to_int(time.second);
+        hint.minute                    = time.minute;
+        hint.hour                      = time.hour;
+        hint.day                       = time.day;
+        hint.month                     = time.month;
+        hint.year                      = time.year;
+        hint.uses_summertime           = time.uses_summertime;
+        hint.leap_second_scheduled     = time.leap_second_scheduled;
+        hint.timezone_change_scheduled = time.timezone_change_scheduled;
+
+        // RTCs do not agree on the weekday numbering
+        hint.weekday = hint.get_bcd_weekday();
+        if (hint.weekday.val == 0) {
+            hint.weekday.val = 7;
+        }
+
+        Clock_Controller::set_time_hint(hint, uncertainty_seconds);
+    }
+
     void print(Clock::time_t time) {
         BCD::print(time.year);
         sprint('-');
@@ -1538,6 +1829,27 @@ namespace Internal {  // DCF77_Frequency_Control
         return deviation;
     }
 
+    int32_t DCF77_Frequency_Control::drift_rate = 0;
+
+    uint16_t DCF77_Frequency_Control::last_correction = 0;
+    uint32_t DCF77_Frequency_Control::get_residual_drift() {
+        // pp16m --> 2^-24
+        const uint32_t corrected_drift = (uint32_t)last_correction * 65536 / 62500;
+        const uint32_t current_drift = drift_rate < 0? -drift_rate: drift_rate;
+        return current_drift > corrected_drift? current_drift: corrected_drift;
+    }
+
+    void DCF77_Frequency_Control::update_drift_rate() {
+        // The deviation is quantized to one tick of the phase lock resolution,
+        // after tau_min_minutes this is 0.5 ppm or better.
+        // The last estimate is kept while the calibration is unqualified,
+        // it is only invalidated by the next adjustment.
+        if (calibration_state.running && calibration_state.qualified && deviation_tracker.good_enough()) {
+            const int32_t rate_per_tick_per_minute = (1UL << 24) / (60UL * Configuration::phase_lock_resolution);
+            drift_rate = (int32_t)deviation * rate_per_tick_per_minute / deviation_tracker.elapsed_minutes;
+        }
+    }
+
     void DCF77_Frequency_Control::adjust() {
         int16_t total_adjust = Generic_1_kHz_Generator::read_adjustment();
         // The proper formula would be
@@ -1559,7 +1871,13 @@ namespace Internal {  // DCF77_Frequency_Control
                                 deviation_tracker.elapsed_minutes;
         if (confirmed_precision == 0) { confirmed_precision = 1; }
 
+        if (total_adjust != 0) {
+            // the clock was tuned before, hence the offset is a measure of its stability
+            last_correction = abs(frequency_offset);
+        }
         total_adjust -= frequency_offset;
+        // the drift was measured against the old adjustment
+        drift_rate = 0;
 
         if (total_adjust >  max_total_adjust) { total_adjust =  max_total_adjust; }
         if (total_adjust < -max_total_adjust) { total_adjust = -max_total_adjust; }
@@ -1571,6 +1889,7 @@ namespace Internal {  // DCF77_Frequency_Control
         const int16_t deviation_to_trigger_readjust = 5;
 
         deviation = compute_phase_deviation(decoded_time.second, decoded_time.minute.digit.lo);
+        update_drift_rate();
 
         if (decoded_time.second == calibration_second) {
             // We might be in an unqualified state and thus the leap second information
@@ -1592,7 +1911,7 @@ namespace Internal {  // DCF77_Frequency_Control
                     if ((Configuration::has_stable_ambient_temperature && deviation_tracker.good_enough() && abs(deviation) >= deviation_to_trigger_readjust) ||
                          deviation_tracker.timeout()) {
                         adjust();
-                        DCF77_Clock_Controller<Configuration, DCF77_Frequency_Control>::on_tuned_clock();
+                        DCF77_Clock_Controller<Configuration, DCF77_Frequency_Control, DCF77_Clock_Monitor>::on_tuned_clock();
 
                         #if defined(_AVR_EEPROM_H_)
                         // enqueue write to eeprom
@@ -1625,6 +1944,10 @@ namespace Internal {  // DCF77_Frequency_Control
         deviation_tracker.process_tick();
     }
 
+    void DCF77_Frequency_Control::process_1_kHz_ticks(const uint8_t ticks) {
+        deviation_tracker.process_ticks(ticks);
+    }
+
     #if defined(_AVR_EEPROM_H_)
     volatile bool DCF77_Frequency_Control::data_pending = false;
 
@@ -1705,14 +2028,20 @@ namespace Internal {  // DCF77_Frequency_Control
         int16_t adjust;
         int8_t ee_precision;
 
+        drift_rate = 0;
+        last_correction = 0;
+
         read_from_eeprom(ee_precision, adjust);
         if (ee_precision) {
-            DCF77_Clock_Controller<Configuration, DCF77_Frequency_Control>::on_tuned_clock();
+            DCF77_Clock_Controller<Configuration, DCF77_Frequency_Control, DCF77_Clock_Monitor>::on_tuned_clock();
         }
         Generic_1_kHz_Generator::adjust(adjust);
     }
     #else
-    void DCF77_Frequency_Control::setup() {}
+    void DCF77_Frequency_Control::setup() {
+        drift_rate = 0;
+        last_correction = 0;
+    }
     #endif
     void DCF77_Frequency_Control::debug() {
         using namespace Debug;
@@ -1736,8 +2065,10 @@ namespace Internal {  // DCF77_Frequency_Control
         sprintln(F(" ticks mod 60000"));
     }
 
-    void DCF77_No_Frequency_Control::process_1_Hz_tick(const DCF77_Encoder &decoded_time) {}
+    void DCF77_No_Frequency_Control::process_1_Hz_tick(const DCF77_Encoder &) {}
     void DCF77_No_Frequency_Control::process_1_kHz_tick() {}
+    void DCF77_No_Frequency_Control::process_1_kHz_ticks(const uint8_t) {}
+    uint32_t DCF77_No_Frequency_Control::get_residual_drift() { return 0; }
     void DCF77_No_Frequency_Control::qualify_calibration() {}
     void DCF77_No_Frequency_Control::unqualify_calibration() {}
     void DCF77_No_Frequency_Control::setup() {}
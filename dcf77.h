@@ -29,6 +29,11 @@
 #if defined(ARDUINO)
 #include "Arduino.h"
 #endif
+#if defined(__unix__)
+#include <stdio.h>
+#include <sys/stat.h>
+#include <time.h>
+#endif
 
 
 struct Configuration {
@@ -40,7 +45,9 @@ struct Configuration {
     // The impact of this is:
     //    - If resolution is set to centi seconds:
     //        -the RAM footprint will be significantly lower
-    //        - clock jitter occurs less often but in 10 ms leaps
+    //        - clock jitter occurs less often but in 10 ms leaps,
+    //          once locked the second boundaries follow the edge of the
+    //          pulse to about 1 ms (see the fine phase of the demodulator)
     //        - auto tune will settle 10 times slower
     //        - filter bandwidth of the demodulator stage is reduced by 10 times
     //            - noise tolerance of this stage is higher
@@ -54,15 +61,16 @@ struct Configuration {
 
     // As a consequency on Atmega 328 (e.g. "Arduino Uno") the resolution must
     // be centi_seconds. On ARM (e.g. "Arduino Due") the resolution may be set
-    // to milli_seconds.
+    // to milli_seconds. AVRs with at least 4 KB of RAM (e.g. Atmega 1284 or
+    // "Arduino Mega") may use milli_seconds with compact (8 bit) phase bins.
 
     // If your application does not need milli second accuracy then the low
     // memory footprint (centi_seconds) option is recommended.
     // If you are in a (electrically) noisy environment the low memory footprint
     // option is recommended.
 
-    // If you are on AVR low memory will be selected and milli second
-    // accuracy will not be achieved.
+    // If you are on an AVR with less than 4 KB of RAM low memory will be
+    // selected and milli second accuracy will not be achieved.
 
     // If you have a resonator instead of a crystal oscillator milli
     // second accuracy will also never be achieved. Pretending to
@@ -75,7 +83,8 @@ struct Configuration {
 
     // 10 ms vs 1 ms sample resolution
     // setting this to true will change the sample resolution to 1 ms for ARM
-    // for AVR there is not enough memory, so for AVR it will default to false
+    // and for AVRs with at least 4 KB of RAM, for smaller AVRs there is not
+    // enough memory, so it will default to false
 
     // the constant(s) below are assumed to be configured by the user of the library
 
@@ -91,8 +100,30 @@ struct Configuration {
     static const bool has_lots_of_memory = false;
     #endif
 
+    // Host builds (unit test, replay of recorded traces) have the trace and
+    // the tick history of an ARM device. A trace replays on the host only
+    // against the same trace_length and tick_history_minutes it was
+    // recorded with.
+    #if defined(__arm__) || defined(__unix__)
+    static const bool has_memory_for_trace = true;
+    #else
+    static const bool has_memory_for_trace = false;
+    #endif
+
+    // 1000 phase bins of one byte each fit into 4 KB of RAM
+    #if defined(__AVR__) && defined(RAMEND) && (RAMEND >= 0x10FF)
+    static const bool has_memory_for_compact_phase_bins = true;
+    #else
+    static const bool has_memory_for_compact_phase_bins = false;
+    #endif
+
     static const bool high_phase_lock_resolution = want_high_phase_lock_resolution &&
-                                                      has_lots_of_memory;
+                                                      (has_lots_of_memory || has_memory_for_compact_phase_bins);
+
+    // Compact phase bins use one byte instead of two. This bounds the
+    // averaging time of the demodulator to 255 seconds instead of 300
+    // seconds once the crystal is tuned.
+    static const bool compact_phase_bins = high_phase_lock_resolution && !has_lots_of_memory;
 
     enum ticks_per_second_t : uint16_t { centi_seconds = 100, milli_seconds = 1000 };
     // this is the actuall sample rate
@@ -121,6 +152,68 @@ struct Configuration {
     // this is completely pointless in the presence of huge changes in ambient temperature.
     static const bool has_stable_ambient_temperature = true;     // indoor deployment
     // static const bool has_stable_ambient_temperature = false; // outdoor deployment
+
+    // Number of seconds kept by the post mortem trace recorder, each second
+    // requires 14 bytes of RAM. 0 disables the recorder. On AVR there is
+    // not enough memory, hence it defaults to 0 there.
+    static const uint16_t trace_length = has_memory_for_trace? 600: 0;
+
+    // Number of minutes of raw ticks kept for rebinning, each minute
+    // requires 15 bytes of RAM. Whenever the second decoder changes the
+    // minute alignment before the clock is locked the minute, hour and
+    // date decoders are rebuilt from this history. The replay is spread
+    // over the following ticks, one minute per tick. 0 disables it.
+    static const uint8_t tick_history_minutes = has_memory_for_trace? 8: 0;
+
+    // Warm restart: while synced the decoder state is persisted every
+    // snapshot_interval seconds (AVR: EEPROM, see auto_persist).
+    // Snapshots older than max_snapshot_age seconds will not be restored.
+    // With increasing age the risk of missed timezone changes or leap
+    // seconds increases.
+    static const uint32_t snapshot_interval = 3600;
+    static const uint32_t max_snapshot_age  = 6UL*60*60;
+
+    // The EEPROM snapshot is opt in. Once enabled, auto_persist() will use
+    // the snapshot_eeprom_size bytes starting at snapshot_eeprom_base, make
+    // sure the sketch does not use them. The default region is the top
+    // quarter of a 1 kB EEPROM (ATmega328). Without snapshots the library
+    // only uses the 8 bytes starting at 0x00.
+    static const bool want_eeprom_snapshot = false;
+    static const uint16_t snapshot_eeprom_base = 0x300;
+    static const uint16_t snapshot_eeprom_size = 0x100;
+
+    // An external time hint adds time_hint_weight to a decoder bin as
+    // soon as the received data agrees with the hint. The hint expires
+    // after time_hint_minutes.
+    static const uint8_t time_hint_weight  = 12;
+    static const uint8_t time_hint_minutes = 60;
+
+    // Weight of a minute frame that passed the parity and plausibility
+    // checks of the frame decoder. Frames are only used before the clock
+    // was locked for the first time.
+    static const uint8_t frame_weight = 12;
+
+    // Binning schedule of the BCD decoders (minute, hour, date). With
+    // annealed_weights the bins start with doubled increments while they
+    // are (almost) empty and fall back to the fixed weights as evidence
+    // builds up. This shortens the time to sync in noisy conditions but
+    // slightly increases the risk of a wrong initial sync for very poor
+    // signals. The second decoder always uses the fixed weights.
+    enum binning_schedule_t : uint8_t { fixed_weights = 0, annealed_weights = 1 };
+    static const binning_schedule_t binning_schedule = fixed_weights;
+
+    // Use the sliding window sequence decoder instead of the binning
+    // decoders for minutes and hours. It only considers the last
+    // sequence_window minutes, each minute of the window costs 2 bytes
+    // of RAM per decoder.
+    static const bool use_sequence_decoder = false;
+    static const uint8_t sequence_window = 30;
+
+    // The monitoring hooks of DCF77_Clock are compiled away by default.
+    // With monitor callbacks the sketch can set handlers for the hooks at
+    // run time (see Internal::DCF77_Callback_Monitor). Each hook will then
+    // cost a check for its handler, even if no handler is set.
+    static const bool want_monitor_callbacks = false;
 };
 
 // https://gcc.gnu.org/onlinedocs/cpp/Stringification.html
@@ -224,6 +317,15 @@ namespace Clock {
     // call output handler once per second
     typedef void (*output_handler_t)(const time_t &decoded_time);
 
+    // A deferred output handler is not called from the interrupt handler.
+    // Instead the clock publishes the time of each second into a single
+    // slot and DCF77_Clock::dispatch_output() calls the handler from the
+    // main loop. If the main loop is slower than 1 Hz only the latest
+    // second will be delivered. latency_ms is the number of milliseconds
+    // that passed between the start of decoded_time and the call of the
+    // handler. Slow handlers can use it to compensate for the delay.
+    typedef void (*deferred_output_handler_t)(const time_t &decoded_time, const uint16_t latency_ms);
+
     // input provider will be called each millisecond and must
     // provide the input of the raw DCF77 signal
     typedef uint8_t (*input_provider_t)(void);
@@ -244,6 +346,12 @@ namespace DCF77_Clock {
 
     void set_input_provider(const Clock::input_provider_t);
     void set_output_handler(const Clock::output_handler_t output_handler);
+    void set_deferred_output_handler(const Clock::deferred_output_handler_t output_handler);
+
+    // non-blocking, call from the main loop to deliver a pending
+    // second to the deferred output handler
+    // returns true if the handler was called
+    bool dispatch_output();
 
     // blocking till start of next second
     void get_current_time(Clock::time_t &now);
@@ -254,7 +362,19 @@ namespace DCF77_Clock {
 
     #if defined(__AVR__)
     void auto_persist();  // this is slow and messes with the interrupt flag, do not call during interrupt handling
+
+    // Warm restart from the decoder state persisted by auto_persist(). Call
+    // after setup(). age_seconds is the time that passed since the state was
+    // persisted, e.g. as determined by an RTC. Returns true if restored.
+    // Requires Configuration::want_eeprom_snapshot.
+    bool restore_state(const uint32_t age_seconds);
     #endif
+
+    // Speeds up the cold start with a time from an RTC or a host clock,
+    // call after setup(). uncertainty_seconds is the maximum expected
+    // deviation of the hinted time.
+    void set_time_hint(const Clock::time_t &time, const uint32_t uncertainty_seconds);
+
     void print(Clock::time_t time);
 
     void debug();
@@ -291,6 +411,11 @@ namespace Internal {
         void bcddigit(uint8_t data);
         void bcddigits(uint8_t data);
         void hexdump(uint8_t data);
+
+        // All debug output of the library goes through sprint / sprintln
+        // and thus to this target. It defaults to Serial.
+        extern Print *output;
+        void set_output(Print &new_output);
     }
 
     namespace DCF77 {
@@ -336,6 +461,10 @@ namespace Internal {
 
         template <bool condition, typename x, typename y> struct if_t             { typedef y type; };
         template <                typename x, typename y> struct if_t<true, x, y> { typedef x type; };
+
+        // number of bits required to represent max
+        template <uint32_t max> struct bit_width    { enum { val = 1 + bit_width<(max >> 1)>::val }; };
+        template <>             struct bit_width<0> { enum { val = 0 }; };
     }
 
     namespace Arithmetic_Tools {
@@ -543,8 +672,232 @@ namespace Internal {
     #endif
 
 
-    #define sprint(...)   Serial.print(__VA_ARGS__)
-    #define sprintln(...) Serial.println(__VA_ARGS__)
+    #define sprint(...)   Internal::Debug::output->print(__VA_ARGS__)
+    #define sprintln(...) Internal::Debug::output->println(__VA_ARGS__)
+
+    namespace Debug {
+        // Non-blocking debug output target. The output is formatted into RAM,
+        // whatever does not fit is dropped and counted instead of blocking
+        // the caller. Call drain() from the main loop to pass the buffered
+        // output on, e.g.
+        //     Internal::Debug::Buffered_Output<128> debug_buffer;
+        //     Internal::Debug::set_output(debug_buffer);
+        //     ...
+        //     debug_buffer.drain(Serial);
+        // The buffer is a lock free single producer single consumer ring.
+        // Hence all output must be written from one context, e.g. the main
+        // loop or one interrupt handler, and drained from one context.
+        template <uint16_t buffer_size>
+        struct Buffered_Output : public Print {
+            typedef bool assert_buffer_size_is_power_of_two_up_to_256[
+                buffer_size > 0 && buffer_size <= 256 && (buffer_size & (buffer_size - 1)) == 0 ? 0: -1];
+
+            static const uint8_t mask = buffer_size - 1;
+
+            // volatile such that the data is stored before head is advanced
+            volatile uint8_t buffer[buffer_size];
+            // 8 bit indices can be read and written atomically, each
+            // index has exactly one writer, thus no locking is required
+            volatile uint8_t head;  // written by the producer
+            volatile uint8_t tail;  // written by drain()
+            volatile uint16_t dropped;
+
+            Buffered_Output() : head(0), tail(0), dropped(0) {}
+
+            virtual size_t write(uint8_t data) {
+                const uint8_t index = head;
+                const uint8_t next = (index + 1) & mask;
+                if (next == tail) {
+                    ++dropped;
+                    return 0;
+                }
+                buffer[index] = data;
+                head = next;
+                return 1;
+            }
+
+            uint16_t get_dropped() {
+                uint16_t result;
+                CRITICAL_SECTION {
+                    result = dropped;
+                }
+                return result;
+            }
+
+            // non-blocking, will pass at most as many bytes as
+            // the target accepts without blocking
+            // returns the number of bytes passed
+            template <typename target_t>
+            uint16_t drain(target_t &target) {
+                int16_t space = target.availableForWrite();
+                uint16_t count = 0;
+                uint8_t index = tail;
+                const uint8_t end = head;
+                while (index != end && space > 0) {
+                    target.write(buffer[index]);
+                    index = (index + 1) & mask;
+                    --space;
+                    ++count;
+                }
+                tail = index;
+                return count;
+            }
+        };
+    }
+
+    namespace Telemetry {
+        // Compact binary alternative to the debug() output. Frames are
+        //     start_byte, frame type, payload length (2 bytes), payload, checksum (2 bytes)
+        // Multi byte values are little endian. The checksum is a Fletcher-16 checksum
+        // over frame type, payload length and payload.
+        typedef void (*byte_sink_t)(const uint8_t data);
+
+        const uint8_t start_byte = 0xA5;
+
+        typedef enum {
+            diagnostics_frame  = 1,
+            statistics_frame   = 2,
+            decoder_bins_frame = 3,
+            phase_bins_frame   = 4,
+            trace_frame        = 5
+        } frame_type_t;
+
+        typedef enum {
+            second_decoder  = 1,
+            minute_decoder  = 2,
+            hour_decoder    = 3,
+            weekday_decoder = 4,
+            day_decoder     = 5,
+            month_decoder   = 6,
+            year_decoder    = 7,
+            decade_decoder  = 8
+        } decoder_id_t;
+
+        // zigzag encoding maps small signed deltas to small unsigned values
+        uint32_t zigzag(const int32_t value);
+        int32_t unzigzag(const uint32_t value);
+
+        // varints store 7 bits per byte, least significant group first
+        uint8_t varint_length(uint32_t value);
+
+        void checksum_add(uint8_t &sum_1, uint8_t &sum_2, const uint8_t data);
+
+        struct Encoder {
+            byte_sink_t sink;
+            uint8_t sum_1;
+            uint8_t sum_2;
+
+            void begin(const byte_sink_t sink, const uint8_t frame_type, const uint16_t payload_length);
+            void put(const uint8_t data);
+            void put_16(const uint16_t data);
+            void put_32(const uint32_t data);
+            void put_varint(uint32_t data);
+            void end();
+        };
+
+        struct Reader {
+            const uint8_t *data;
+            uint16_t length;
+            uint16_t position;
+            // will be cleared if anything is read beyond the payload
+            bool ok;
+
+            void setup(const uint8_t *data, const uint16_t length);
+            uint8_t get();
+            uint16_t get_16();
+            uint32_t get_32();
+            uint32_t get_varint();
+        };
+
+        // Receiving side, intended for the host. Feed each received byte into
+        // receive(). It returns true once a complete frame with a valid checksum
+        // is available in frame_type / payload. Corrupted or oversized frames
+        // are dropped and the decoder hunts for the next start byte.
+        template <uint16_t max_payload_length>
+        struct Decoder {
+            typedef enum { hunting, type, length_lo, length_hi, payload_data, checksum_1, checksum_2 } state_t;
+
+            state_t  state;
+            uint8_t  frame_type;
+            uint16_t payload_length;
+            uint16_t received;
+            uint8_t  payload[max_payload_length];
+
+            uint8_t  sum_1;
+            uint8_t  sum_2;
+            uint32_t dropped_frames;
+
+            void setup() {
+                state = hunting;
+                dropped_frames = 0;
+            }
+
+            void drop() {
+                ++dropped_frames;
+                state = hunting;
+            }
+
+            bool receive(const uint8_t data) {
+                switch (state) {
+                    case hunting:
+                        if (data == start_byte) {
+                            sum_1 = 0;
+                            sum_2 = 0;
+                            state = type;
+                        }
+                        return false;
+
+                    case type:
+                        frame_type = data;
+                        checksum_add(sum_1, sum_2, data);
+                        state = length_lo;
+                        return false;
+
+                    case length_lo:
+                        payload_length = data;
+                        checksum_add(sum_1, sum_2, data);
+                        state = length_hi;
+                        return false;
+
+                    case length_hi:
+                        payload_length |= (uint16_t)data << 8;
+                        checksum_add(sum_1, sum_2, data);
+                        received = 0;
+                        if (payload_length > max_payload_length) {
+                            drop();
+                        } else {
+                            state = payload_length > 0? payload_data: checksum_1;
+                        }
+                        return false;
+
+                    case payload_data:
+                        payload[received] = data;
+                        checksum_add(sum_1, sum_2, data);
+                        if (++received == payload_length) {
+                            state = checksum_1;
+                        }
+                        return false;
+
+                    case checksum_1:
+                        if (data == sum_1) {
+                            state = checksum_2;
+                        } else {
+                            drop();
+                        }
+                        return false;
+
+                    case checksum_2:
+                        state = hunting;
+                        if (data == sum_2) {
+                            return true;
+                        }
+                        ++dropped_frames;
+                        return false;
+                }
+                return false;
+            }
+        };
+    }
 
     namespace Binning {
         template <typename uint_t>
@@ -561,13 +914,13 @@ namespace Internal {
         }
 
         template <typename data_t, typename signal_t, signal_t signal_max>
-        void score(data_t &value, const signal_t signal, const bool bit) {
+        void score(data_t &value, const signal_t signal, const bool bit, const uint8_t gain) {
             // it is assumed that the caller takes care of potential overflow condition
             // before calling the score function
             if (bit) {
-                value += signal;
+                value += gain * signal;
             } else {
-                value += signal_max - signal;
+                value += gain * (signal_max - signal);
             }
         }
 
@@ -746,6 +1099,33 @@ namespace Internal {
             typedef typename bins_t<data_type, data_type, number_of_bins>::index_t index_t;
             typedef data_type data_t;
 
+            // While set BCD_binning only compares the received bits against the
+            // predicted bin (signal_max_index) as long as they agree with it. The
+            // agreeing bits are scored into all bins at once at the end of the
+            // field, thus the bins stay the same as with the full sweep. The
+            // first disagreement falls back to the full sweep. See set_fast_path.
+            bool fast_path;
+            uint8_t fast_path_bits;
+
+            // While set the binning increments are annealed, see get_gain.
+            // Set by the clock controller according to its configuration,
+            // setup() does not change it.
+            bool annealed = false;
+
+            void setup() {
+                bins_t<data_type, data_type, number_of_bins>::setup();
+                fast_path = false;
+                fast_path_bits = 0;
+            }
+
+            void set_fast_path(const bool enabled) {
+                fast_path = enabled;
+            }
+
+            void set_annealed(const bool enabled) {
+                annealed = enabled;
+            }
+
             void compute_max_index() {
                 this->noise_max = 0;
                 this->signal_max = 0;
@@ -796,6 +1176,136 @@ namespace Internal {
                 sprintln();
             }
 
+            // scale of the binning increments, with the annealed schedule
+            // empty bins score twice until signal_max reaches 64
+            uint8_t get_gain() {
+                return annealed && this->signal_max < 64? 2: 1;
+            }
+
+            // rotates the bins such that get_time_value() will return value
+            void align(const BCD::bcd_t value) {
+                const index_t offset = (number_of_bins == 60 ||
+                                        number_of_bins == 24 ||
+                                        number_of_bins == 10)? 0x00: 0x01;
+                const uint8_t target = BCD::bcd_to_int(value) - offset;
+
+                if (this->signal_max_index < number_of_bins && target < number_of_bins) {
+                    this->tick = (2*number_of_bins + target - 1 - this->signal_max_index) % number_of_bins;
+                }
+            }
+
+            // returns the bin that currently maps to value or number_of_bins if value is invalid
+            index_t get_bin_index(const BCD::bcd_t value) {
+                const index_t offset = (number_of_bins == 60 ||
+                                        number_of_bins == 24 ||
+                                        number_of_bins == 10)? 0x00: 0x01;
+                const uint8_t target = BCD::bcd_to_int(value) - offset;
+
+                return target < number_of_bins? (2*number_of_bins + target - 1 - this->tick) % number_of_bins: number_of_bins;
+            }
+
+            // returns the value bin index currently maps to, inverse of get_bin_index
+            BCD::bcd_t get_bin_value(const index_t index) {
+                const index_t offset = (number_of_bins == 60 ||
+                                        number_of_bins == 24 ||
+                                        number_of_bins == 10)? 0x00: 0x01;
+
+                return BCD::int_to_bcd((index + this->tick + 1) % number_of_bins + offset);
+            }
+
+            // returns the strongest bin besides signal_max_index
+            index_t get_runner_up_index() {
+                index_t runner_up = this->signal_max_index == 0? 1: 0;
+                for (index_t index = 0; index < number_of_bins; ++index) {
+                    if (index != this->signal_max_index && this->data[index] > this->data[runner_up]) {
+                        runner_up = index;
+                    }
+                }
+                return runner_up;
+            }
+
+            // adds weight to the bin that currently maps to value
+            void seed(const BCD::bcd_t value, const uint8_t weight) {
+                const index_t index = get_bin_index(value);
+                if (index < number_of_bins) {
+                    Arithmetic_Tools::bounded_add(this->data[index], weight);
+                    compute_max_index();
+                }
+            }
+
+            void send_telemetry(const Telemetry::byte_sink_t sink, const uint8_t decoder_id) {
+                Decoder snapshot;
+                CRITICAL_SECTION {
+                    snapshot = *this;
+                }
+
+                Telemetry::Encoder encoder;
+                encoder.begin(sink, Telemetry::decoder_bins_frame, 7 + number_of_bins);
+                encoder.put(decoder_id);
+                encoder.put(number_of_bins);
+                encoder.put(snapshot.tick);
+                encoder.put(snapshot.signal_max_index);
+                encoder.put(snapshot.signal_max);
+                encoder.put(snapshot.noise_max);
+                encoder.put(snapshot.get_quality_factor());
+                for (index_t index = 0; index < number_of_bins; ++index) {
+                    encoder.put(snapshot.data[index]);
+                }
+                encoder.end();
+            }
+
+            // Scores the first received bits of the field, as collected by the
+            // fast path, into all bins. Each bin is visited twice instead of
+            // once per bit. Up to the rare clipping at upper_bin_bound the
+            // result is the same as if the bits had been binned by the full sweep.
+            template <uint8_t significant_bits, bool with_parity>
+            void score_fast_path_bits(const uint8_t bits, const data_t upper_bin_bound) {
+                using namespace Arithmetic_Tools;
+                using namespace BCD;
+
+                const uint8_t number_of_bits = significant_bits + with_parity;
+                const uint8_t mask = (1 << bits) - 1;
+                const uint8_t gain = get_gain();
+                const index_t offset = number_of_bins-1-this->tick;
+
+                // first pass, range of the new scores
+                bcd_t candidate;
+                candidate.val = (with_parity || number_of_bins == 10)? 0x00: 0x01;
+                uint16_t min = 0xffff;
+                uint16_t max = 0;
+                index_t bin_index = offset;
+                for (index_t pass=0; pass < number_of_bins; ++pass) {
+                    const uint8_t candidate_bits = with_parity? set_bit(candidate.val, significant_bits, parity(candidate.val)): candidate.val;
+                    const uint16_t value = this->data[bin_index] +
+                                           gain * (bits - bit_count((candidate_bits ^ fast_path_bits) & mask));
+                    maximize(max, value);
+                    minimize(min, value);
+
+                    bin_index = bin_index < number_of_bins-1? bin_index+1: 0;
+                    increment(candidate);
+                }
+
+                // enforce min == 0 and max < upper_bin_bound - number_of_bits
+                // like the full sweep
+                uint16_t decrement = min;
+                while (max - decrement >= upper_bin_bound - number_of_bits) {
+                    decrement += number_of_bits;
+                }
+
+                // second pass, store the new scores
+                candidate.val = (with_parity || number_of_bins == 10)? 0x00: 0x01;
+                bin_index = offset;
+                for (index_t pass=0; pass < number_of_bins; ++pass) {
+                    const uint8_t candidate_bits = with_parity? set_bit(candidate.val, significant_bits, parity(candidate.val)): candidate.val;
+                    const uint16_t value = this->data[bin_index] +
+                                           gain * (bits - bit_count((candidate_bits ^ fast_path_bits) & mask));
+                    this->data[bin_index] = value > decrement? value - decrement: 0;
+
+                    bin_index = bin_index < number_of_bins-1? bin_index+1: 0;
+                    increment(candidate);
+                }
+            }
+
             template <typename signal_t, signal_t signal_max, uint8_t signal_bitno_offset, uint8_t significant_bits, bool with_parity>
             void BCD_binning(const uint8_t bitno_with_offset, const signal_t signal) {
                 using namespace Arithmetic_Tools;
@@ -808,9 +1318,40 @@ namespace Internal {
 
                 const uint8_t number_of_bits = significant_bits + with_parity;
                 if (bitno > number_of_bits) { return; }
-                if (bitno == number_of_bits) { compute_max_index(); return; }
 
                 const data_t upper_bin_bound = TMP::equal<data_t, uint8_t>::val? 255 : (60 * number_of_bits * signal_max) / 2;
+                const uint8_t gain = get_gain();
+                // the fast path applies to binary signals only
+                const bool use_fast_path = signal_max == 1 && fast_path && this->signal_max_index < number_of_bins;
+
+                if (bitno == number_of_bits) {
+                    if (use_fast_path) {
+                        score_fast_path_bits<significant_bits, with_parity>(number_of_bits, upper_bin_bound);
+                    }
+                    compute_max_index();
+                    return;
+                }
+
+                if (use_fast_path) {
+                    // the predicted value is the value the strongest bin maps to
+                    const bcd_t predicted = int_to_bcd((this->signal_max_index + this->tick + 1) % number_of_bins +
+                                                       ((with_parity || number_of_bins == 10)? 0x00: 0x01));
+                    const bool predicted_bit = bitno < significant_bits? (predicted.val >> bitno) & 1
+                                                                       : parity(predicted.val);
+
+                    if (bitno == 0) {
+                        fast_path_bits = 0;
+                    }
+                    if (predicted_bit == (signal > signal_max / 2)) {
+                        fast_path_bits |= predicted_bit << bitno;
+                        return;
+                    }
+
+                    // disagreement, the bits so far are scored into all bins and
+                    // the remaining bits of this minute are binned completely
+                    score_fast_path_bits<significant_bits, with_parity>(bitno, upper_bin_bound);
+                    fast_path = false;
+                }
 
                 // for minutes, hours have parity and start counting at 0
                 // for days, weeks, month we have no parity and start counting at 1
@@ -827,12 +1368,12 @@ namespace Internal {
                     data_t& current_bin = this->data[bin_index];
                     if (bitno < significant_bits) {
                         // score vs. bcd value determined by pass
-                        score<data_t, signal_t, signal_max>(current_bin, signal, (candidate.val >> bitno) & 1);
+                        score<data_t, signal_t, signal_max>(current_bin, signal, (candidate.val >> bitno) & 1, gain);
                     } else
                     if (with_parity) {
                         if (bitno == significant_bits) {
                             // score vs. parity bit
-                            score<data_t, signal_t, signal_max>(current_bin, signal, parity(candidate.val));
+                            score<data_t, signal_t, signal_max>(current_bin, signal, parity(candidate.val), gain);
                         }
                     }
 
@@ -865,6 +1406,109 @@ namespace Internal {
         };
 
 
+        // Sliding window decoder for the minute and hour fields. Since the
+        // bins are rotated by advance_tick (minute + 1, hour rollover,
+        // timezone changes) each bin follows one sequence of values. The
+        // maximum likelihood sequence over the window is the bin with the
+        // most matching bits. The last window frames are kept, the oldest
+        // frame is removed from the scores as soon as a new frame arrives.
+        // Like the binning decoders it expects 1 for long or undefined ticks,
+        // undefined ticks are almost always damaged long ticks.
+        template <uint32_t number_of_bins, uint8_t signal_bitno_offset, uint8_t significant_bits, uint8_t window>
+        struct Sequence_Decoder : Decoder<uint8_t, number_of_bins> {
+            typedef typename Decoder<uint8_t, number_of_bins>::index_t index_t;
+            // significant bits + parity
+            static const uint8_t number_of_bits = significant_bits + 1;
+            typedef bool assert_window_fits_into_scores[window * number_of_bits <= 255? 1: -1];
+
+            typedef struct {
+                uint8_t bits;  // received bits
+                // rotation of the bins when the frame was received, the frame is
+                // removed from the same bins it was added to even if the bins were
+                // aligned in between
+                uint8_t tick;
+            } frame_t;
+
+            frame_t frames[window];
+            uint8_t frame_count;
+            uint8_t next_frame;
+            frame_t current;
+
+            // sum of the matching bits over the window, data holds score - min(score)
+            uint8_t score[number_of_bins];
+
+            void setup() {
+                Decoder<uint8_t, number_of_bins>::setup();
+                frame_count = 0;
+                next_frame = 0;
+                current.bits = 0;
+                for (index_t index = 0; index < number_of_bins; ++index) {
+                    score[index] = 0;
+                }
+            }
+
+            // number of bits of frame that match the value of bin index
+            uint8_t get_frame_score(const frame_t &frame, const index_t index) {
+                using namespace Arithmetic_Tools;
+
+                const BCD::bcd_t candidate = BCD::int_to_bcd((index + frame.tick + 1) % number_of_bins);
+                const uint8_t bits = candidate.val | parity(candidate.val) << significant_bits;
+                return number_of_bits - bit_count(bits ^ frame.bits);
+            }
+
+            void update_data() {
+                uint8_t min = 255;
+                for (index_t index = 0; index < number_of_bins; ++index) {
+                    Arithmetic_Tools::minimize(min, score[index]);
+                }
+                for (index_t index = 0; index < number_of_bins; ++index) {
+                    this->data[index] = score[index] - min;
+                }
+                this->compute_max_index();
+            }
+
+            void add_frame() {
+                using namespace Arithmetic_Tools;
+
+                current.tick = this->tick;
+                frame_t &oldest = frames[next_frame];
+                for (index_t index = 0; index < number_of_bins; ++index) {
+                    if (frame_count == window) {
+                        bounded_sub(score[index], get_frame_score(oldest, index));
+                    }
+                    bounded_add(score[index], get_frame_score(current, index));
+                }
+                oldest = current;
+                next_frame = next_frame < window-1? next_frame+1: 0;
+                if (frame_count < window) { ++frame_count; }
+
+                update_data();
+            }
+
+            void process_tick(const uint8_t current_second, const uint8_t tick_value) {
+                if (current_second < signal_bitno_offset) { return; }
+                const uint8_t bitno = current_second - signal_bitno_offset;
+
+                if (bitno < number_of_bits) {
+                    if (bitno == 0) {
+                        current.bits = 0;
+                    }
+                    current.bits |= (tick_value != 0) << bitno;
+                } else if (bitno == number_of_bits) {
+                    add_frame();
+                }
+            }
+
+            void seed(const BCD::bcd_t value, const uint8_t weight) {
+                const index_t index = this->get_bin_index(value);
+                if (index < number_of_bins) {
+                    Arithmetic_Tools::bounded_add(score[index], weight);
+                    update_data();
+                }
+            }
+
+        };
+
         template <typename data_type, uint32_t number_of_bins>
         struct Convoluter : bins_t<data_type, uint32_t, number_of_bins> {
             typedef typename bins_t<data_type, data_type, number_of_bins>::index_t index_t;
@@ -915,10 +1559,80 @@ namespace Internal {
         };
     }
 
+    // Monitoring policy of the clock controller. The hooks are called from
+    // the 1 kHz interrupt, thus monitors must be fast. The default monitor
+    // does nothing, since all hooks are inlined the calls will be optimized
+    // away completely. Custom monitors should derive from DCF77_No_Monitor
+    // and hide only the hooks they are interested in.
+    struct DCF77_No_Monitor {
+        // each raw sample as passed to the clock controller
+        static void on_sample(const uint8_t) __attribute__((always_inline)) {}
+        // each (averaged) bin after phase binning
+        static void on_bin_average(const uint16_t, const uint8_t) __attribute__((always_inline)) {}
+        // the demodulator decided about the tick of the current second
+        static void on_tick_decision(const DCF77::tick_t) __attribute__((always_inline)) {}
+        // the tick as passed to the decoders, second is the decoded second
+        static void on_second_tick(const uint8_t, const DCF77::tick_t) __attribute__((always_inline)) {}
+        static void on_clock_state_change(const Clock::clock_state_t,
+                                          const Clock::clock_state_t) __attribute__((always_inline)) {}
+    };
+
+    // Monitor for sketches, forwards the hooks to the handlers set at run
+    // time. Hooks without a handler do nothing. DCF77_Clock uses it if
+    // Configuration::want_monitor_callbacks is set.
+    struct DCF77_Callback_Monitor {
+        typedef void (*sample_handler_t)(const uint8_t sampled_data);
+        typedef void (*bin_average_handler_t)(const uint16_t bin, const uint8_t average);
+        typedef void (*tick_decision_handler_t)(const DCF77::tick_t tick_data);
+        typedef void (*second_tick_handler_t)(const uint8_t second, const DCF77::tick_t tick_data);
+        typedef void (*clock_state_change_handler_t)(const Clock::clock_state_t old_state,
+                                                     const Clock::clock_state_t new_state);
+
+        static sample_handler_t             sample_handler;              // = 0;
+        static bin_average_handler_t        bin_average_handler;         // = 0;
+        static tick_decision_handler_t      tick_decision_handler;       // = 0;
+        static second_tick_handler_t        second_tick_handler;         // = 0;
+        static clock_state_change_handler_t clock_state_change_handler;  // = 0;
+
+        static void set_sample_handler(const sample_handler_t handler) { sample_handler = handler; }
+        static void set_bin_average_handler(const bin_average_handler_t handler) { bin_average_handler = handler; }
+        static void set_tick_decision_handler(const tick_decision_handler_t handler) { tick_decision_handler = handler; }
+        static void set_second_tick_handler(const second_tick_handler_t handler) { second_tick_handler = handler; }
+        static void set_clock_state_change_handler(const clock_state_change_handler_t handler) { clock_state_change_handler = handler; }
+
+        static void on_sample(const uint8_t sampled_data) __attribute__((always_inline)) {
+            if (sample_handler) { sample_handler(sampled_data); }
+        }
+        static void on_bin_average(const uint16_t bin, const uint8_t average) __attribute__((always_inline)) {
+            if (bin_average_handler) { bin_average_handler(bin, average); }
+        }
+        static void on_tick_decision(const DCF77::tick_t tick_data) __attribute__((always_inline)) {
+            if (tick_decision_handler) { tick_decision_handler(tick_data); }
+        }
+        static void on_second_tick(const uint8_t second, const DCF77::tick_t tick_data) __attribute__((always_inline)) {
+            if (second_tick_handler) { second_tick_handler(second, tick_data); }
+        }
+        static void on_clock_state_change(const Clock::clock_state_t old_state,
+                                          const Clock::clock_state_t new_state) __attribute__((always_inline)) {
+            if (clock_state_change_handler) { clock_state_change_handler(old_state, new_state); }
+        }
+    };
+
+    // the monitor of DCF77_Clock
+    typedef TMP::if_t<Configuration::want_monitor_callbacks,
+                      DCF77_Callback_Monitor, DCF77_No_Monitor>::type DCF77_Clock_Monitor;
+
+    template <typename Clock_Controller>
+    struct DCF77_Demodulator_Bins {
+        typedef typename TMP::if_t<Clock_Controller::Configuration::compact_phase_bins, uint8_t, uint16_t>::type data_t;
+        typedef Binning::Convoluter<data_t, Clock_Controller::Configuration::phase_lock_resolution> type;
+    };
+
     template <typename Clock_Controller>
-    struct DCF77_Demodulator : Binning::Convoluter<uint16_t, Clock_Controller::Configuration::phase_lock_resolution> {
-        typedef typename Binning::Convoluter<uint16_t, Clock_Controller::Configuration::phase_lock_resolution>::index_t index_t;
-        typedef typename Binning::Convoluter<uint16_t, Clock_Controller::Configuration::phase_lock_resolution>::data_t data_t;
+    struct DCF77_Demodulator : DCF77_Demodulator_Bins<Clock_Controller>::type {
+        typedef typename DCF77_Demodulator_Bins<Clock_Controller>::type convoluter_t;
+        typedef typename convoluter_t::index_t index_t;
+        typedef typename convoluter_t::data_t data_t;
 
         static const index_t bin_count = Clock_Controller::Configuration::phase_lock_resolution;
         static const uint16_t samples_per_second = 1000;
@@ -955,10 +1669,58 @@ namespace Internal {
         // For resonators we will allow slightly higher phase drift thresholds.
         // This is because otherwise we will not be able to deal with noise
         // in any reasonable way.
+        // compact phase bins may bound N
+        static const uint16_t tuned_N = tuned_ticks_to_drift_one_tick / bin_count < TMP::limits<data_t>::max?
+                                        (uint16_t)(tuned_ticks_to_drift_one_tick / bin_count) : (uint16_t)TMP::limits<data_t>::max;
+
         uint16_t N = ticks_to_drift_one_tick / bin_count;
+        // N as set by setup() resp. set_has_tuned_clock(), applies while the drift is unknown
+        uint16_t nominal_N = ticks_to_drift_one_tick / bin_count;
         void set_has_tuned_clock() {
             // will be called once crystal is tuned to better than 1 ppm.
-            N = tuned_ticks_to_drift_one_tick / bin_count;
+            nominal_N = tuned_N;
+            N = tuned_N;
+        }
+
+        // the residual drift is measured in 1/drift_sample samples per sample
+        static const int32_t drift_sample = (int32_t)1 << 24;
+
+        // a measured drift of up to 120 ppm can be followed
+        static const uint16_t min_N = ticks_to_drift_one_tick / 4 / bin_count;
+
+        // Adapts N to the residual drift measured by the frequency control,
+        // drift as computed by Frequency_Control::get_residual_drift(), 0 if unknown.
+        // N is the number of seconds it takes to drift by one bin, it is
+        // rounded down to nominal_N / 2^k such that it will not change back and
+        // forth with each update of the measurement. N is never raised above
+        // nominal_N as the measured drift lags behind temperature changes.
+        void adapt_N(const uint32_t drift) {
+            uint16_t target = nominal_N;
+            if (drift != 0) {
+                const uint32_t seconds_to_drift_one_bin = (uint32_t)drift_sample / bin_count / drift;
+                while (target > seconds_to_drift_one_bin && (target >> 1) >= min_N) {
+                    target >>= 1;
+                }
+                if (target > N && 2*(uint32_t)target > seconds_to_drift_one_bin) {
+                    // growing requires a margin of one step
+                    target = (target >> 1) > N? target >> 1: N;
+                }
+            }
+            if (target < N) {
+                // scale down instead of clipping, clipping would flatten the pulse shape
+                // target and N are both nominal_N / 2^k, thus shifting is sufficient
+                uint8_t shift = 0;
+                while ((N >> shift) > target) {
+                    ++shift;
+                }
+                for (index_t bin = 0; bin < bin_count; ++bin) {
+                    this->data[bin] >>= shift;
+                }
+                integral          >>= shift;
+                running_max       >>= shift;
+                running_noise_max >>= shift;
+            }
+            N = target;
         }
 
         int32_t integral = 0;
@@ -967,17 +1729,32 @@ namespace Internal {
         int32_t running_noise_max = 0;
 
         void setup() {
-            Binning::Convoluter<uint16_t, Clock_Controller::Configuration::phase_lock_resolution>::setup();
+            convoluter_t::setup();
             integral = 0;
             running_max = 0;
             running_max_index = 0;
             running_noise_max = 0;
             N = ticks_to_drift_one_tick / bin_count;
+            nominal_N = N;
+
+            previous_input = 0;
+            transitions = 0;
+            idle_seconds = 0;
+            pulse_count = 0;
+            gap_count = 0;
+            search_seconds = max_search_seconds;
+            contrast = 0;
+            carrier_present = false;
+
+            restart_fine_phase(0);
+            fine_index = fine_index_idle;
+            flush_countdown = 0;
+            flush_scheduled = false;
         }
 
         void phase_binning(const uint8_t input)
                 __attribute__((always_inline)) {
-            Binning::Convoluter<uint16_t, Clock_Controller::Configuration::phase_lock_resolution>::advance_tick();
+            convoluter_t::advance_tick();
             const index_t tick = this->tick;
 
             data_t & data = this->data[tick];
@@ -986,13 +1763,16 @@ namespace Internal {
                 data = N;
             }
 
-            if (input) {
-                if (data < N) {
-                    ++data;
-                }
-            } else {
-                if (data > 0) {
-                    --data;
+            // a stuck input carries no phase information, the bins are kept as they are
+            if (idle_seconds < max_idle_seconds) {
+                if (input) {
+                    if (data < N) {
+                        ++data;
+                    }
+                } else {
+                    if (data > 0) {
+                        --data;
+                    }
                 }
             }
 
@@ -1030,6 +1810,75 @@ namespace Internal {
             }
         }
 
+        // Full sweep of the phase convolution kernel, that is twice the first
+        // 100 ms plus the next 100 ms of the window starting at each bin.
+        // The window is advanced in three runs that do not cross the end of
+        // the bins, thus there is no wrap() per bin. Works on any copy of the
+        // bins, e.g. on phase bins captured by send_telemetry().
+        static void sweep_phase(const data_t *data, uint32_t &max, index_t &max_index, uint32_t &noise_max) {
+            uint32_t integral = 0;
+            for (index_t bin = 0; bin < bins_per_100ms; ++bin) {
+                integral += ((uint32_t)data[bin])<<1;
+            }
+            for (index_t bin = bins_per_100ms; bin < bins_per_200ms; ++bin) {
+                integral += (uint32_t)data[bin];
+            }
+
+            max = 0;
+            max_index = 0;
+            index_t start = 0;
+            // the whole window is inside of the bins
+            for (; start < bin_count - bins_per_200ms; ++start) {
+                if (integral > max) {
+                    max = integral;
+                    max_index = start;
+                }
+                integral += (uint32_t)data[start + bins_per_100ms] + data[start + bins_per_200ms];
+                integral -= ((uint32_t)data[start])<<1;
+            }
+            // the second 100 ms wrap
+            for (; start < bin_count - bins_per_100ms; ++start) {
+                if (integral > max) {
+                    max = integral;
+                    max_index = start;
+                }
+                integral += (uint32_t)data[start + bins_per_100ms] + data[start + bins_per_200ms - bin_count];
+                integral -= ((uint32_t)data[start])<<1;
+            }
+            // both halves wrap
+            for (; start < bin_count; ++start) {
+                if (integral > max) {
+                    max = integral;
+                    max_index = start;
+                }
+                integral += (uint32_t)data[start + bins_per_100ms - bin_count] + data[start + bins_per_200ms - bin_count];
+                integral -= ((uint32_t)data[start])<<1;
+            }
+
+            // same noise estimate as phase_binning, the window shifted by 200 ms
+            const index_t noise_index = wrap(max_index + bins_per_200ms);
+            noise_max = 0;
+            for (index_t bin = 0; bin < bins_per_100ms; ++bin) {
+                noise_max += ((uint32_t)data[wrap(noise_index + bin)])<<1;
+            }
+            for (index_t bin = bins_per_100ms; bin < bins_per_200ms; ++bin) {
+                noise_max += (uint32_t)data[wrap(noise_index + bin)];
+            }
+        }
+
+        // Phase binning publishes the phase once per period. This publishes
+        // the phase of the current bins right away.
+        void research_phase() {
+            uint32_t max;
+            index_t max_index;
+            uint32_t noise_max;
+            sweep_phase(this->data, max, max_index, noise_max);
+
+            this->signal_max       = max;
+            this->signal_max_index = max_index;
+            this->noise_max        = noise_max;
+        }
+
         typename TMP::uval_t<bin_count>::type count = 0;
         uint8_t decoded_data = 0;
         void decode_200ms(const uint8_t input, const uint8_t bins_to_go) {
@@ -1037,6 +1886,7 @@ namespace Internal {
             // will be called for each bin during the "interesting" 200 ms
             if (bins_to_go == bins_per_100ms + 1) {
                 decoded_data = ((count > bins_per_50ms)? 2: 0);
+                pulse_count = count;
                 count = 0;
             }
             if (bins_to_go == 0) {
@@ -1047,40 +1897,228 @@ namespace Internal {
                 //               2 --> 0,
                 //               1 --> undefined,
                 //               0 --> sync_mark
+                Clock_Controller::Monitor::on_tick_decision((DCF77::tick_t) decoded_data);
                 Clock_Controller::process_single_tick_data((DCF77::tick_t) decoded_data);
             }
         }
 
-        typename TMP::uval_t<bins_per_200ms+2>::type bins_to_go = 0;
-        void detector_stage_2(const uint8_t input) {
-            const index_t current_bin = this->tick;
-            if (bins_to_go == 0) {
-                if (wrap((bin_count + current_bin + 1 - this->signal_max_index)) <= bins_per_100ms ||   // current_bin at most 100ms after phase_bin
-                    wrap((bin_count + this->signal_max_index - current_bin)) <= 1                  ) {  // current bin at most 1 tick before phase_bin
-                    // if phase bin varies to much during one period we will always be screwed in may ways...
-                    // last tick of current second
-                    Clock_Controller::flush();
-                    // start processing of bins
-                    bins_to_go = bins_per_200ms + 2;
+        // Carrier detection. The receiver output of a present carrier has
+        // edges and is high during the first 100 ms after the phase bin but
+        // low during the 800 ms after the decoding window. A receiver that
+        // lost the carrier is either stuck or emits noise without contrast.
+        static const uint8_t  max_idle_seconds = 2;  // the sync mark has no edges either
+        static const uint8_t  max_search_seconds = 16;
+        static const uint16_t pulse_bins = bins_per_100ms + 1;
+        static const uint16_t gap_bins   = bin_count - bins_per_200ms - 2;
+
+        uint8_t previous_input = 0;
+        uint8_t transitions = 0;
+        uint8_t idle_seconds = 0;
+        uint8_t search_seconds = max_search_seconds;
+        typename TMP::uval_t<bin_count>::type pulse_count = 0;
+        typename TMP::uval_t<bin_count>::type gap_count = 0;
+        // low pass of the per second contrast, 16 times the
+        // contrast per second in steady state, thus at most 16*gap_bins
+        int16_t contrast = 0;
+        bool carrier_present = false;
+
+        // will be called once per second when the decoding window starts
+        void detect_carrier() {
+            idle_seconds = transitions > 0? 0: idle_seconds < max_idle_seconds? idle_seconds + 1: idle_seconds;
+
+            // the pulse density is scaled to the gap, thus noise averages to 0
+            contrast += (int16_t)((int32_t)pulse_count * gap_bins / pulse_bins) - (int16_t)gap_count - contrast / 16;
+
+            transitions = 0;
+            pulse_count = 0;
+            gap_count = 0;
+
+            // hysteresis, noise with 40% flipped bins still passes
+            const bool present = idle_seconds < max_idle_seconds &&
+                                 contrast > (carrier_present? (int16_t)(3*gap_bins/4): (int16_t)(3*gap_bins/2));
+            if (present != carrier_present) {
+                carrier_present = present;
+                if (present) {
+                    // the phase published by phase_binning was integrated
+                    // while the carrier returned, search it from the bins
+                    research_phase();
+                    Clock_Controller::carrier_regained_event_handler();
+                } else {
+                    Clock_Controller::carrier_lost_event_handler();
                 }
             }
 
-            if (bins_to_go > 0) {
-                --bins_to_go;
-
-                // this will be called for each bin in the "interesting" 200ms
-                // this is also a good place for a "monitoring hook"
-                decode_200ms(input, bins_to_go);
+            if (present) {
+                search_seconds = max_search_seconds;
+            } else if (idle_seconds == max_idle_seconds) {
+                // the bins are preserved while the input is stuck
+                search_seconds = 0;
+            } else if (idle_seconds == 0 && search_seconds < max_search_seconds) {
+                // The input toggles again but shows no contrast at the
+                // preserved phase. Thus the phase moved meanwhile and
+                // the preserved bins would only slow down the search.
+                if (++search_seconds == max_search_seconds) {
+                    memset(this->data, 0, sizeof(this->data));
+                    integral = 0;
+                    running_max = 0;
+                }
             }
         }
 
-        // The struct below would better capture the whole code of detector_stage_1 for the_score
-        // "with averages" case. However the straighforward approach leads to lots of nasty
-        // complications with template scoping. Hence detector_stage_1 is still a function
-        // and detector dispatches.
-        struct stage_with_averages {
-            uint8_t sample_count = 0;
-            uint8_t sum = 0;
+        // Fine phase. The phase bins are computed from bin averages, thus
+        // signal_max_index is only accurate to one bin. Once the coarse phase
+        // is known a window of fine bins, one per sample, covers the bins
+        // around the phase bin. The edge of the pulse is in the bin before
+        // the phase bin or in the phase bin itself. The window is wider to
+        // keep the edge while the phase bins lag a drifting phase. The fine
+        // bins are bounded counters like the phase bins. The edge is where
+        // the step from low to high fits the fine bins best. Then the
+        // flush is delayed such that it happens at the edge instead of at the
+        // end of the bin that contains the edge. If the window loses the edge
+        // the flush falls back to the coarse bin boundaries.
+        static const uint8_t fine_lead_bins = 2;    // window bins before the phase bin
+        static const uint8_t fine_window_bins = 4;
+        static const uint8_t fine_bin_count = fine_window_bins*samples_per_bin;
+        static const uint8_t fine_N = 32;
+        static const uint8_t fine_index_idle = 0xff;
+        static const uint8_t edge_unknown = 0xff;
+
+        uint8_t fine_data[fine_bin_count];
+        uint8_t fine_index = fine_index_idle;
+        index_t fine_phase_bin = 0;
+        // samples from the start of the fine window to the edge
+        uint8_t edge_offset = edge_unknown;
+        uint8_t flush_countdown = 0;
+        bool flush_scheduled = false;
+
+        void restart_fine_phase(const index_t phase_bin) {
+            memset(fine_data, fine_N / 2, sizeof(fine_data));
+            fine_phase_bin = phase_bin;
+            edge_offset = edge_unknown;
+        }
+
+        // will be called for each sample of the fine window
+        void fine_binning(const uint8_t sampled_data) {
+            uint8_t & data = fine_data[fine_index];
+            if (sampled_data) {
+                if (data < fine_N) { ++data; }
+            } else {
+                if (data > 0) { --data; }
+            }
+            if (++fine_index == fine_bin_count) {
+                fine_index = fine_index_idle;
+            }
+        }
+
+        // will be called for each bin after phase binning
+        void fine_phase() {
+            const index_t bin = this->tick;
+            const index_t phase_bin = this->signal_max_index;
+
+            if (bin == wrap(bin_count + phase_bin - fine_lead_bins - 1)) {
+                // the next bin is the first bin of the window
+                if (phase_bin != fine_phase_bin) {
+                    // Follow a coarse step by one bin, the fine bins of
+                    // the bin that left the window are lost.
+                    if (phase_bin == wrap(fine_phase_bin + 1)) {
+                        memmove(fine_data, fine_data + samples_per_bin, fine_bin_count - samples_per_bin);
+                        memset(fine_data + fine_bin_count - samples_per_bin, fine_data[fine_bin_count - samples_per_bin - 1], samples_per_bin);
+                        fine_phase_bin = phase_bin;
+                        edge_offset = edge_offset != edge_unknown && edge_offset > samples_per_bin?
+                                      edge_offset - samples_per_bin: edge_unknown;
+                    } else if (wrap(phase_bin + 1) == fine_phase_bin) {
+                        memmove(fine_data + samples_per_bin, fine_data, fine_bin_count - samples_per_bin);
+                        memset(fine_data, fine_data[0], samples_per_bin);
+                        fine_phase_bin = phase_bin;
+                        edge_offset = edge_offset < fine_bin_count - samples_per_bin?
+                                      edge_offset + samples_per_bin: edge_unknown;
+                    } else {
+                        restart_fine_phase(phase_bin);
+                    }
+                }
+                fine_index = 0;
+            } else if (bin == wrap(phase_bin + fine_window_bins - fine_lead_bins - 1) && phase_bin == fine_phase_bin) {
+                // Step kernel: -1 before the edge, +1 after the edge. The
+                // score of the edge at k is sum(j >= k) - sum(j < k) of
+                // the fine bins centered around fine_N / 2.
+                int16_t score = 0;
+                for (uint8_t index = 0; index < fine_bin_count; ++index) {
+                    score += 2*(int16_t)fine_data[index] - fine_N;
+                }
+                int16_t max_score = score;
+                uint8_t edge = 0;
+                for (uint8_t index = 0; index < fine_bin_count; ++index) {
+                    score -= 2*(2*(int16_t)fine_data[index] - fine_N);
+                    if (score > max_score) {
+                        max_score = score;
+                        edge = index + 1;
+                    }
+                }
+                // the edge must be inside the window with a clear step
+                edge_offset = edge > 0 && edge < fine_bin_count &&
+                              max_score > (int16_t)(fine_bin_count * fine_N / 2)? edge: edge_unknown;
+            }
+        }
+
+        // will be called for each sample while a flush is scheduled
+        void process_flush_countdown() {
+            if (--flush_countdown == 0) {
+                Clock_Controller::flush();
+            }
+        }
+
+        typename TMP::uval_t<bins_per_200ms+2>::type bins_to_go = 0;
+        void detector_stage_2(const uint8_t input) {
+            const index_t current_bin = this->tick;
+            Clock_Controller::Monitor::on_bin_average(current_bin, input);
+
+            if (input != previous_input && transitions < 255) {
+                ++transitions;
+            }
+            previous_input = input;
+
+            if (requires_averages && bins_to_go == 0 && edge_offset != edge_unknown &&
+                current_bin == wrap(bin_count + this->signal_max_index - fine_lead_bins - 1)) {
+                // the next bin is the first bin of the fine window, flush at the edge
+                flush_scheduled = true;
+                flush_countdown = edge_offset;
+                if (flush_countdown == 0) {
+                    Clock_Controller::flush();
+                }
+            }
+
+            if (bins_to_go == 0) {
+                if (wrap((bin_count + current_bin + 1 - this->signal_max_index)) <= bins_per_100ms ||   // current_bin at most 100ms after phase_bin
+                    wrap((bin_count + this->signal_max_index - current_bin)) <= 1                  ) {  // current bin at most 1 tick before phase_bin
+                    // if phase bin varies to much during one period we will always be screwed in may ways...
+                    detect_carrier();
+                    // last tick of current second, unless it is placed at the edge
+                    if (!flush_scheduled) {
+                        Clock_Controller::flush();
+                    }
+                    flush_scheduled = false;
+                    // start processing of bins
+                    bins_to_go = bins_per_200ms + 2;
+                } else {
+                    gap_count += input;
+                }
+            }
+
+            if (bins_to_go > 0) {
+                --bins_to_go;
+
+                // this will be called for each bin in the "interesting" 200ms
+                decode_200ms(input, bins_to_go);
+            }
+        }
+
+        // The struct below would better capture the whole code of detector_stage_1 for the_score
+        // "with averages" case. However the straighforward approach leads to lots of nasty
+        // complications with template scoping. Hence detector_stage_1 is still a function
+        // and detector dispatches.
+        struct stage_with_averages {
+            uint8_t sample_count = 0;
+            uint8_t sum = 0;
 
             void reset() __attribute__ ((always_inline)) {
                 sample_count = 0;
@@ -1096,6 +2134,9 @@ namespace Internal {
             uint8_t avg() const __attribute__ ((always_inline)) {
                 return sum > samples_per_bin / 2;
             }
+            bool empty() const __attribute__ ((always_inline)) {
+                return sample_count == 0;
+            }
         };
 
         struct dummy_stage {
@@ -1103,6 +2144,7 @@ namespace Internal {
             void    reduce(const uint8_t sampled_data) const {}
             bool    data_ready()                       const {}
             uint8_t avg()                              const {}
+            bool    empty()                            const { return true; }
         };
 
         static const bool requires_averages = samples_per_bin > 1;
@@ -1117,15 +2159,30 @@ namespace Internal {
                 // that is each 10ms control is passed to stage 2
                 const uint8_t input = stage_1.avg();
 
-                phase_binning(input);
-                detector_stage_2(input);
+                detector_bin(input);
 
                 stage_1.reset();
             }
         }
 
+        // Stage 2 entry for callers that already averaged a whole bin,
+        // input is the bin average as computed by stage_1.avg().
+        void detector_bin(const uint8_t input) __attribute__((always_inline)) {
+            phase_binning(input);
+            if (requires_averages) {
+                fine_phase();
+            }
+            detector_stage_2(input);
+        }
+
         void detector(const uint8_t sampled_data) {
             if (samples_per_bin > 1) {
+                if (flush_countdown > 0) {
+                    process_flush_countdown();
+                }
+                if (fine_index != fine_index_idle) {
+                    fine_binning(sampled_data);
+                }
                 // average samples
                 detector_stage_1(sampled_data);
             } else {
@@ -1137,7 +2194,59 @@ namespace Internal {
 
         void debug() {
             sprint(F("Phase: "));
-            Binning::Convoluter<uint16_t, Clock_Controller::Configuration::phase_lock_resolution>::debug();
+            convoluter_t::debug();
+        }
+
+        // The phase bins are sent as one frame per chunk of telemetry_chunk
+        // bins. Each chunk is copied under its own short critical section,
+        // thus neither the stack nor the interrupt latency grow with
+        // bin_count. Each frame is consistent on its own.
+        static const uint8_t telemetry_chunk = 32;
+
+        void send_telemetry(const Telemetry::byte_sink_t sink) {
+            for (uint16_t first_bin = 0; first_bin < bin_count; first_bin += telemetry_chunk) {
+                const uint8_t chunk = bin_count - first_bin < telemetry_chunk? bin_count - first_bin: telemetry_chunk;
+                data_t data[telemetry_chunk];
+                index_t tick;
+                index_t signal_max_index;
+                uint32_t signal_max;
+                uint32_t noise_max;
+                uint16_t N;
+
+                CRITICAL_SECTION {
+                    memcpy(data, this->data + first_bin, chunk * sizeof(data_t));
+                    tick             = this->tick;
+                    signal_max_index = this->signal_max_index;
+                    signal_max       = this->signal_max;
+                    noise_max        = this->noise_max;
+                    N                = this->N;
+                }
+
+                // adjacent bins differ only slightly, thus they are delta encoded
+                uint16_t payload_length = 19;
+                data_t previous = 0;
+                for (uint8_t bin = 0; bin < chunk; ++bin) {
+                    payload_length += Telemetry::varint_length(Telemetry::zigzag((int32_t)data[bin] - previous));
+                    previous = data[bin];
+                }
+
+                Telemetry::Encoder encoder;
+                encoder.begin(sink, Telemetry::phase_bins_frame, payload_length);
+                encoder.put_16(bin_count);
+                encoder.put_16(first_bin);
+                encoder.put(chunk);
+                encoder.put_16(tick);
+                encoder.put_16(signal_max_index);
+                encoder.put_32(signal_max);
+                encoder.put_32(noise_max);
+                encoder.put_16(N);
+                previous = 0;
+                for (uint8_t bin = 0; bin < chunk; ++bin) {
+                    encoder.put_varint(Telemetry::zigzag((int32_t)data[bin] - previous));
+                    previous = data[bin];
+                }
+                encoder.end();
+            }
         }
 
         void debug_verbose() {
@@ -1201,6 +2310,140 @@ namespace Internal {
         }
     };
 
+    // Averaging and phase binning for many receivers at once, e.g. for test
+    // racks or for replaying the recordings of a fleet. Each bit of word_t
+    // is one channel. The sample sums and the phase bins are kept in bit
+    // plane form, that is plane k holds bit k of the counters of all
+    // channels. Hence the 1 kHz part costs a few word operations for all
+    // channels together. The phase bins of each channel match the bins of a
+    // DCF77_Demodulator that is fed with the same samples. Evaluating the
+    // phase and decoding the ticks stays per channel.
+    template <typename Clock_Controller, typename word_t>
+    struct DCF77_Bitsliced_Demodulator {
+        typedef DCF77_Demodulator<Clock_Controller> demodulator_t;
+        typedef typename demodulator_t::index_t index_t;
+        typedef typename demodulator_t::data_t data_t;
+
+        static const uint8_t channel_count = 8*sizeof(word_t);
+        static const index_t bin_count = demodulator_t::bin_count;
+        static const uint16_t samples_per_bin = demodulator_t::samples_per_bin;
+
+        static const uint8_t sum_planes = TMP::bit_width<samples_per_bin>::val;
+        static const uint8_t bin_planes = TMP::bit_width<demodulator_t::tuned_N>::val;
+
+        word_t sum[sum_planes];
+        uint8_t sample_count;
+
+        word_t data[bin_count][bin_planes];
+        index_t tick;
+
+        // shared by all channels, it may only grow as the bins are not clamped
+        uint16_t N;
+
+        // channels in this mask keep their bins, e.g. while their carrier is absent
+        word_t hold;
+        // the averages of the most recent bin
+        word_t input;
+
+        void setup() {
+            memset(sum, 0, sizeof(sum));
+            sample_count = 0;
+            memset(data, 0, sizeof(data));
+            tick = 0;
+            N = demodulator_t::ticks_to_drift_one_tick / bin_count;
+            hold = 0;
+            input = 0;
+        }
+
+        void set_has_tuned_clock() {
+            N = demodulator_t::tuned_N;
+        }
+
+        void phase_binning(const word_t input) {
+            if (tick < bin_count - 1) {
+                ++tick;
+            } else {
+                tick = 0;
+            }
+            word_t * const planes = data[tick];
+
+            word_t at_N = ~(word_t)0;
+            word_t not_0 = 0;
+            for (uint8_t plane = 0; plane < bin_planes; ++plane) {
+                at_N &= (N >> plane) & 1? planes[plane]: ~planes[plane];
+                not_0 |= planes[plane];
+            }
+
+            // bounded increment and decrement in one pass, the masks are disjoint
+            word_t carry  =  input & ~hold & ~at_N;
+            word_t borrow = ~input & ~hold & not_0;
+            for (uint8_t plane = 0; plane < bin_planes; ++plane) {
+                const word_t bits = planes[plane];
+                planes[plane] = bits ^ carry ^ borrow;
+                carry  &=  bits;
+                borrow &= ~bits;
+            }
+        }
+
+        // Each bit of sampled_data is the sample of one channel. Returns
+        // true whenever a bin was completed, the bin averages are in input.
+        bool detector(const word_t sampled_data) {
+            if (samples_per_bin > 1) {
+                word_t carry = sampled_data;
+                for (uint8_t plane = 0; plane < sum_planes && carry; ++plane) {
+                    const word_t bits = sum[plane];
+                    sum[plane] = bits ^ carry;
+                    carry &= bits;
+                }
+                if (++sample_count < samples_per_bin) {
+                    return false;
+                }
+
+                // average = sum > samples_per_bin / 2, compared from the top plane
+                word_t greater = 0;
+                word_t equal = ~(word_t)0;
+                for (uint8_t plane = sum_planes; plane-- > 0; ) {
+                    if (((samples_per_bin / 2) >> plane) & 1) {
+                        equal &= sum[plane];
+                    } else {
+                        greater |= equal & sum[plane];
+                        equal &= ~sum[plane];
+                    }
+                }
+                input = greater;
+
+                memset(sum, 0, sizeof(sum));
+                sample_count = 0;
+            } else {
+                input = sampled_data;
+            }
+            phase_binning(input);
+            return true;
+        }
+
+        // the phase bins of one channel in the layout of DCF77_Demodulator::data
+        void get_bins(const uint8_t channel, data_t *bins) const {
+            for (index_t bin = 0; bin < bin_count; ++bin) {
+                const word_t * const planes = data[bin];
+                data_t value = 0;
+                for (uint8_t plane = bin_planes; plane-- > 0; ) {
+                    value = (value << 1) | ((data_t)(planes[plane] >> channel) & 1);
+                }
+                bins[bin] = value;
+            }
+        }
+
+        // The phase of one channel, see DCF77_Demodulator::sweep_phase.
+        // Unpacking the bins costs about as much as binning one channel for
+        // a second, as the phase drifts slowly it need not be evaluated every
+        // second.
+        void get_phase(const uint8_t channel, uint32_t &max, index_t &max_index, uint32_t &noise_max) const {
+            data_t bins[bin_count];
+            get_bins(channel, bins);
+            demodulator_t::sweep_phase(bins, max, max_index, noise_max);
+        }
+    };
+
     struct DCF77_Flag_Decoder {
         bool abnormal_transmitter_operation;
         int8_t timezone_change_scheduled;
@@ -1240,6 +2483,8 @@ namespace Internal {
         DCF77_Decade_Decoder Decade_Decoder;
 
         void advance_tick();
+        void set_fast_path(const bool enabled);
+        void set_annealed(const bool enabled);
         void process_tick(const uint8_t current_second, const uint8_t tick_value);
         void get_quality(lock_quality_t &lock_quality);
         uint8_t get_quality_factor();
@@ -1297,6 +2542,8 @@ namespace Internal {
         void convolution_binning(const uint8_t tick_data);
         void sync_mark_binning(const uint8_t tick_data);
         uint8_t get_time_value();
+        void align(const uint8_t second);
+        void seed(const uint8_t second, const uint8_t weight);
         void binning(const DCF77::tick_t tick_data);
         void debug();
     };
@@ -1326,24 +2573,31 @@ namespace Internal {
             local_clock_time.reset();
         }
 
+        void set_clock_state(const Clock::clock_state_t new_state) __attribute__((always_inline)) {
+            if (clock_state != new_state) {
+                Clock_Controller::Monitor::on_clock_state_change(clock_state, new_state);
+                clock_state = new_state;
+            }
+        }
+
         void process_1_Hz_tick(const DCF77_Encoder &decoded_time) {
             uint8_t quality_factor = Clock_Controller::get_overall_quality_factor();
 
             if (quality_factor > Clock_Controller::Configuration::quality_factor_sync_threshold) {
                 if (clock_state != Clock::synced) {
                     Clock_Controller::sync_achieved_event_handler();
-                    clock_state = Clock::synced;
+                    set_clock_state(Clock::synced);
                 }
             } else if (clock_state == Clock::synced) {
                 Clock_Controller::sync_lost_event_handler();
-                clock_state = Clock::locked;
+                set_clock_state(Clock::locked);
             }
 
             while (true) {
                 switch (clock_state) {
                     case Clock::useless: {
                         if (quality_factor > 0) {
-                            clock_state = Clock::dirty;
+                            set_clock_state(Clock::dirty);
                             break;  // goto dirty state
                         } else {
                             second_toggle = !second_toggle;
@@ -1353,7 +2607,7 @@ namespace Internal {
 
                     case Clock::dirty: {
                         if (quality_factor == 0) {
-                            clock_state = Clock::useless;
+                            set_clock_state(Clock::useless);
                             second_toggle = !second_toggle;
                             local_clock_time.reset();
                             return;
@@ -1391,7 +2645,7 @@ namespace Internal {
                             second_toggle = !second_toggle;
                             return;
                         } else {
-                            clock_state = Clock::unlocked;
+                            set_clock_state(Clock::unlocked);
                             Clock_Controller::phase_lost_event_handler();
                             unlocked_seconds = 0;
                             return;
@@ -1406,7 +2660,8 @@ namespace Internal {
                                 // Deviation of local phase vs. decoded phase exceeds 200 ms.
                                 // So something is not OK. We can not relock.
                                 // On the other hand we are still below max_unlocked_seconds.
-                                // --> Stay in unlocked mode.
+                                // --> Stay in unlocked mode, the decoders have to start over.
+                                Clock_Controller::decoders_stale_event_handler();
                                 return;
                             } else {
                                 // Phase drift was below 200 ms and clock was not unlocked
@@ -1415,12 +2670,17 @@ namespace Internal {
                                 //     missed leap seconds.
                                 // We ignore this issue as it is not worse than running in
                                 // free mode.
-                                clock_state = Clock::locked;
+                                set_clock_state(Clock::locked);
                                 if (tick < 200) {
                                     // time output was handled at most 200 ms before
                                     tick = 0;
+                                    Clock_Controller::phase_regained_event_handler(local_clock_time);
                                     return;
                                 } else {
+                                    // the locked state will advance to the next second
+                                    DCF77_Encoder current_time = local_clock_time;
+                                    current_time.advance_second();
+                                    Clock_Controller::phase_regained_event_handler(current_time);
                                     break;  // goto locked state
                                 }
                             }
@@ -1437,6 +2697,23 @@ namespace Internal {
             }
         }
 
+        // Number of 1 kHz ticks that can pass before process_1_kHz_tick
+        // has to do more than counting.
+        uint16_t ticks_without_event() const {
+            const uint16_t event_tick = clock_state == Clock::synced   ||
+                                        clock_state == Clock::locked   ? 1150:
+                                        clock_state == Clock::unlocked ||
+                                        clock_state == Clock::free     ? 1000:
+                                                                         0xffff;
+            return tick < event_tick - 1? event_tick - 1 - tick: 0;
+        }
+
+        // Bulk version of process_1_kHz_tick,
+        // requires ticks <= ticks_without_event().
+        void skip_1_kHz_ticks(const uint16_t ticks) {
+            tick += ticks;
+        }
+
         void process_1_kHz_tick() {
             ++tick;
 
@@ -1449,7 +2726,7 @@ namespace Internal {
                     unlocked_seconds = 1;
 
                     // 1 Hz tick missing for more than 1200ms
-                    clock_state = Clock::unlocked;
+                    set_clock_state(Clock::unlocked);
                     Clock_Controller::phase_lost_event_handler();
                 }
             }
@@ -1473,7 +2750,8 @@ namespace Internal {
 
                     ++unlocked_seconds;
                     if (unlocked_seconds > max_unlocked_seconds) {
-                        clock_state = Clock::free;
+                        set_clock_state(Clock::free);
+                        Clock_Controller::decoders_stale_event_handler();
                     }
                 }
             }
@@ -1577,6 +2855,17 @@ namespace Internal {
                 }
             }
 
+            // same as calling process_tick() ticks times
+            void process_ticks(const uint8_t ticks) {
+                // ticks < 256, thus it wraps at most once
+                uint16_t elapsed = elapsed_ticks_mod_60000 + ticks;
+                if (elapsed >= 60000) {
+                    elapsed -= 60000;
+                    ++elapsed_minutes;
+                }
+                elapsed_ticks_mod_60000 = elapsed;
+            }
+
             int16_t compute_phase_deviation(uint8_t current_second, uint8_t current_minute_mod_10) {
                 int32_t deviation =
                         ((int32_t) elapsed_ticks_mod_60000) -
@@ -1623,6 +2912,25 @@ namespace Internal {
                 }
             }
 
+            // same as calling process_tick() ticks times
+            void process_ticks(const uint8_t ticks) {
+                uint16_t total = divider + ticks;
+                uint8_t divided_ticks = 0;
+                while (total >= 10) {
+                    total -= 10;
+                    ++divided_ticks;
+                }
+                divider = total;
+
+                if (divided_ticks > 0) {
+                    // divided_ticks < 6000, thus at most one minute boundary is passed
+                    if (elapsed_ticks_mod_60000 % 6000 + divided_ticks >= 6000) {
+                        ++elapsed_minutes;
+                    }
+                    generic_deviation_tracker_t::process_ticks(divided_ticks);
+                }
+            }
+
             int16_t compute_phase_deviation(uint8_t current_second, uint8_t current_minute_mod_10) {
                 int32_t deviation =
                         ((int32_t) elapsed_ticks_mod_60000) -
@@ -1654,14 +2962,21 @@ namespace Internal {
 
         static volatile calibration_state_t calibration_state;
         static volatile int16_t deviation;
+        // Residual drift of the 1 kHz generator against DCF77 in 2^-24 ticks
+        // per tick, positive if the generator is fast. 0 until a qualified
+        // calibration ran for tau_min_minutes and again after each adjustment.
+        static int32_t drift_rate;
+        static uint16_t last_correction;
 
         static void restart_measurement();
         static void debug();
         static bool increase_tau();
         static bool decrease_tau();
         static void adjust();
+        static void update_drift_rate();
         static void process_1_Hz_tick(const DCF77_Encoder &decoded_time);
         static void process_1_kHz_tick();
+        static void process_1_kHz_ticks(const uint8_t ticks);
 
         static void qualify_calibration();
         static void unqualify_calibration();
@@ -1671,6 +2986,10 @@ namespace Internal {
         static calibration_state_t get_calibration_state();
         // The phase deviation is only meaningful if calibration is running.
         static int16_t get_current_deviation();
+        // Upper estimate of the residual drift in 2^-24 ticks per tick, that is
+        // the larger of the current drift and the correction of the last
+        // adjustment of an already tuned clock. 0 if unknown.
+        static uint32_t get_residual_drift();
 
         static void setup();
 
@@ -1698,9 +3017,11 @@ namespace Internal {
     struct DCF77_No_Frequency_Control {
         static void process_1_Hz_tick(const DCF77_Encoder &decoded_time);
         static void process_1_kHz_tick();
+        static void process_1_kHz_ticks(const uint8_t ticks);
 
         static void qualify_calibration();
         static void unqualify_calibration();
+        static uint32_t get_residual_drift();
 
         static void setup();
 
@@ -1718,20 +3039,165 @@ namespace Internal {
 
     namespace DCF77_Naive_Bitstream_Decoder {
         void set_bit(const uint8_t second, const uint8_t value, DCF77_Encoder &now);
+
+        // Decodes complete minute frames without any binning. The frame
+        // decoder finds the start of the minute by itself, thus it does not
+        // depend on the second decoder. A frame is only considered valid if
+        // all decoded ticks were clean, the start of minute and start of time markers
+        // are present, all parities check, all values are in range and the
+        // weekday matches the date.
+        struct Frame_Decoder {
+            DCF77_Encoder frame;
+            uint8_t second;
+            bool valid;
+            uint8_t parity;
+
+            void setup();
+            // returns true if the tick was the sync mark of a valid frame
+            bool process_tick(const uint8_t tick_data);
+        };
     }
 
-    template <typename Configuration_T, typename Frequency_Control>
+    // one record per demodulated tick
+    typedef struct {
+        uint8_t  tick_and_state;    // bit 0..1: DCF77::tick_t, bit 2..4: Clock::clock_state_t, bit 5: carrier absent
+        uint8_t  second;            // second the tick was decoded for
+        uint16_t phase;             // Demodulator signal_max_index
+        uint16_t local_clock_tick;  // ms since the last local clock flush
+        uint8_t  quality_factor[8]; // phase, second, minute, hour, weekday, day, month, year
+    } trace_record_t;
+
+    // Circular post mortem trace of the decoder state. It can be frozen
+    // after a failure and dumped with send_telemetry(). The trace_frame
+    // payload is the number of records written since setup (4 bytes)
+    // followed by the records, oldest first, in the memory layout above.
+    template <uint16_t trace_length>
+    struct Trace_Recorder {
+        trace_record_t records[trace_length];
+        uint32_t written;
+        uint16_t next;
+        volatile bool frozen;
+
+        void setup() {
+            CRITICAL_SECTION {
+                written = 0;
+                next = 0;
+                frozen = false;
+            }
+        }
+
+        void freeze()   { frozen = true;  }
+        void unfreeze() { frozen = false; }
+
+        void record(const DCF77::tick_t tick_data, const uint8_t second, const uint16_t phase,
+                    const Clock::clock_state_t clock_state, const bool carrier_absent,
+                    const uint16_t local_clock_tick, const uint8_t quality_factor[8]) {
+            if (frozen) { return; }
+
+            trace_record_t &record = records[next];
+            record.tick_and_state   = tick_data | (clock_state << 2) | (carrier_absent << 5);
+            record.second           = second;
+            record.phase            = phase;
+            record.local_clock_tick = local_clock_tick;
+            memcpy(record.quality_factor, quality_factor, sizeof(record.quality_factor));
+
+            next = next < trace_length - 1? next + 1: 0;
+            ++written;
+        }
+
+        void send_telemetry(const Telemetry::byte_sink_t sink) {
+            const bool was_frozen = frozen;
+            freeze();
+
+            const uint16_t count = written < trace_length? written: trace_length;
+            uint16_t index = written < trace_length? 0: next;
+
+            Telemetry::Encoder encoder;
+            encoder.begin(sink, Telemetry::trace_frame, 4 + count * sizeof(trace_record_t));
+            encoder.put_32(written);
+            for (uint16_t record = 0; record < count; ++record) {
+                const uint8_t *data = (const uint8_t *)&records[index];
+                for (uint8_t offset = 0; offset < sizeof(trace_record_t); ++offset) {
+                    encoder.put(data[offset]);
+                }
+                index = index < trace_length - 1? index + 1: 0;
+            }
+            encoder.end();
+
+            frozen = was_frozen;
+        }
+    };
+
+    template <>
+    struct Trace_Recorder<0> {
+        void setup() {}
+        void freeze() {}
+        void unfreeze() {}
+        void record(const DCF77::tick_t, const uint8_t, const uint16_t,
+                    const Clock::clock_state_t, const bool,
+                    const uint16_t, const uint8_t[8]) __attribute__((always_inline)) {}
+        void send_telemetry(const Telemetry::byte_sink_t) {}
+    };
+
+    // Circular store of the most recent ticks, 2 bits per tick.
+    template <uint8_t history_minutes>
+    struct Tick_History {
+        static const uint16_t length = 60 * (uint16_t)history_minutes;
+        uint8_t data[length / 4];
+        uint16_t next;
+        uint16_t count;
+
+        void setup() {
+            next = 0;
+            count = 0;
+        }
+
+        void push(const DCF77::tick_t tick_data) {
+            const uint8_t shift = (next & 3) << 1;
+            uint8_t &slot = data[next >> 2];
+            slot = (slot & ~(3 << shift)) | (tick_data << shift);
+
+            next = next < length - 1? next + 1: 0;
+            if (count < length) { ++count; }
+        }
+
+        // age 0 is the most recent tick, age must be less than count
+        DCF77::tick_t get(const uint16_t age) const {
+            const uint16_t index = (next + 2*length - 1 - age) % length;
+            return (DCF77::tick_t)((data[index >> 2] >> ((index & 3) << 1)) & 3);
+        }
+    };
+
+    template <>
+    struct Tick_History<0> {
+        static const uint16_t count = 0;
+
+        void setup() {}
+        void push(const DCF77::tick_t) __attribute__((always_inline)) {}
+        DCF77::tick_t get(const uint16_t) const { return DCF77::undefined; }
+    };
+
+    template <typename Configuration_T, typename Frequency_Control, typename Monitor_T = DCF77_No_Monitor>
     struct DCF77_Clock_Controller {
         typedef Configuration_T Configuration;
+        typedef Monitor_T Monitor;
 
         static DCF77_Second_Decoder  Second_Decoder;
-        static DCF77_Minute_Decoder  Minute_Decoder;
-        static DCF77_Hour_Decoder    Hour_Decoder;
+        typedef typename TMP::if_t<Configuration::use_sequence_decoder,
+                                   Binning::Sequence_Decoder<60, 21, 7, Configuration::sequence_window>,
+                                   DCF77_Minute_Decoder>::type minute_decoder_t;
+        typedef typename TMP::if_t<Configuration::use_sequence_decoder,
+                                   Binning::Sequence_Decoder<24, 29, 6, Configuration::sequence_window>,
+                                   DCF77_Hour_Decoder>::type hour_decoder_t;
+
+        static minute_decoder_t      Minute_Decoder;
+        static hour_decoder_t        Hour_Decoder;
         static DCF77_Weekday_Decoder Weekday_Decoder;
         static DCF77_Day_Decoder     Day_Decoder;
         static DCF77_Month_Decoder   Month_Decoder;
         static DCF77_Year_Decoder    Year_Decoder;
         static DCF77_Flag_Decoder    Flag_Decoder;
+        static DCF77_Naive_Bitstream_Decoder::Frame_Decoder Frame_Decoder;
 
         // blocking, will unblock at the start of the second
         static void get_current_time(DCF77_Encoder &now) {
@@ -1764,6 +3230,20 @@ namespace Internal {
             // decoded time. If the decoders are out of sync this may not be
             // called at all.
 
+            if (carrier_absent) {
+                // the local clock coasts on the 1 kHz tick, it will
+                // unlock if the carrier does not return within one second
+                publish_diagnostics();
+                return;
+            }
+
+            if (decoders_frozen) {
+                // the local clock keeps the time until the phase returns
+                Local_Clock.process_1_Hz_tick(decoded_time);
+                publish_diagnostics();
+                return;
+            }
+
             DCF77_Encoder now;
             DCF77_Encoder now_1;
 
@@ -1812,10 +3292,16 @@ namespace Internal {
 
                 // reset leap second
                 leap_second &= leap_second < 2;
+
+                if (restore_state == restore_aligned) {
+                    restore_state = restore_idle;
+                }
             }
 
             // pass control to local clock
             Local_Clock.process_1_Hz_tick(decoded_time);
+
+            publish_diagnostics();
         }
 
         static Clock::output_handler_t output_handler; //= 0;
@@ -1823,6 +3309,39 @@ namespace Internal {
             output_handler = new_output_handler;
         }
 
+        static Clock::deferred_output_handler_t deferred_output_handler; //= 0;
+        static void set_deferred_output_handler(const Clock::deferred_output_handler_t new_output_handler) {
+            CRITICAL_SECTION {
+                deferred_output_handler = new_output_handler;
+                output_pending = false;
+            }
+        }
+
+        // single slot mailbox between local_clock_flush and dispatch_output
+        static Clock::time_t output_mailbox;
+        static volatile bool output_pending;
+
+        static bool dispatch_output() {
+            Clock::time_t time;
+            uint16_t latency_ms;
+            Clock::deferred_output_handler_t handler;
+
+            CRITICAL_SECTION {
+                if (!output_pending) {
+                    return false;
+                }
+                time = output_mailbox;
+                // Local_Clock.tick is reset at each flush, thus it is
+                // the time since the start of the published second
+                latency_ms = Local_Clock.tick;
+                handler = deferred_output_handler;
+                output_pending = false;
+            }
+
+            handler(time, latency_ms);
+            return true;
+        }
+
         static void local_clock_flush(const DCF77_Encoder &decoded_time) {
             // This is the callback for the "local clock".
             // It will be called once per second.
@@ -1833,8 +3352,9 @@ namespace Internal {
             // frequency control must be handled before output handling, otherwise
             // output handling might introduce undesirable jitter to frequency control
             Frequency_Control::process_1_Hz_tick(decoded_time);
+            Demodulator.adapt_N(Frequency_Control::get_residual_drift());
 
-            if (output_handler) {
+            if (output_handler || deferred_output_handler) {
                 Clock::time_t time;
 
                 time.second                    = BCD::int_to_bcd(decoded_time.second);
@@ -1847,7 +3367,16 @@ namespace Internal {
                 time.uses_summertime           = decoded_time.uses_summertime;
                 time.leap_second_scheduled     = decoded_time.leap_second_scheduled;
                 time.timezone_change_scheduled = decoded_time.timezone_change_scheduled;
-                output_handler(time);
+
+                if (deferred_output_handler) {
+                    // publish only, the handler will run in dispatch_output()
+                    output_mailbox = time;
+                    output_pending = true;
+                }
+
+                if (output_handler) {
+                    output_handler(time);
+                }
             }
 
             if (decoded_time.second == 15 && Local_Clock.clock_state != Clock::useless
@@ -1862,9 +3391,191 @@ namespace Internal {
         // both basically belong to "the hardware". Thus the clock
         // controller will not care to much about them.
         static void process_1_kHz_tick_data(const uint8_t sampled_data) {
+            Monitor::on_sample(sampled_data);
             Demodulator.detector(sampled_data);
             Local_Clock.process_1_kHz_tick();
             Frequency_Control::process_1_kHz_tick();
+            count_seconds();
+        }
+
+        // Same as calling process_1_kHz_tick_data for each of the samples,
+        // intended for inputs that buffer samples and for replaying recordings.
+        // The samples are packed 32 per word, the oldest sample in bit 0.
+        // Whenever a whole bin is available and neither the local clock nor
+        // the statistics are due within the bin, the bin is averaged at once
+        // and the 1 kHz bookkeeping is advanced in bulk. Everything else
+        // takes the per sample path.
+        static void process_samples(const uint32_t *packed, const uint32_t sample_count) {
+            const uint8_t samples_per_bin = Demodulator.samples_per_bin;
+
+            uint32_t sample = 0;
+            while (sample < sample_count) {
+                if (Demodulator.stage_1.empty() &&
+                    Demodulator.flush_countdown == 0 &&
+                    Demodulator.fine_index == Demodulator.fine_index_idle &&
+                    sample_count - sample >= samples_per_bin &&
+                    Local_Clock.ticks_without_event() >= samples_per_bin - 1 &&
+                    statistics_ms + samples_per_bin - 1 < 1000) {
+
+                    const uint8_t offset = sample & 31;
+                    uint32_t bits = packed[sample >> 5] >> offset;
+                    if (offset + samples_per_bin > 32) {
+                        bits |= packed[(sample >> 5) + 1] << (32 - offset);
+                    }
+                    if (samples_per_bin < 32) {
+                        bits &= (((uint32_t) 1) << samples_per_bin) - 1;
+                    }
+                    sample += samples_per_bin;
+
+                    for (uint8_t bit = 0; bit < samples_per_bin; ++bit) {
+                        Monitor::on_sample((bits >> bit) & 1);
+                    }
+
+                    // all but the last sample of the bin only need to be counted
+                    Local_Clock.skip_1_kHz_ticks(samples_per_bin - 1);
+                    Frequency_Control::process_1_kHz_ticks(samples_per_bin - 1);
+                    statistics_ms += samples_per_bin - 1;
+
+                    Demodulator.detector_bin(__builtin_popcountl(bits) > samples_per_bin / 2);
+                    Local_Clock.process_1_kHz_tick();
+                    Frequency_Control::process_1_kHz_tick();
+                    count_seconds();
+                } else {
+                    process_1_kHz_tick_data((packed[sample >> 5] >> (sample & 31)) & 1);
+                    ++sample;
+                }
+            }
+        }
+
+        // Feeds one tick to the minute, hour, date and flag decoders.
+        // now.second is the second the tick was received in.
+        static void bin_tick(const DCF77_Encoder &now, const DCF77::tick_t tick_data) {
+            using namespace DCF77;
+
+            if (now.second == 0) {
+                Minute_Decoder.advance_tick();
+                if (now.minute.val == 0x00) {
+
+                    // "while" takes automatically care of timezone change
+                    while (Hour_Decoder.get_time_value().val <= 0x23 &&
+                        Hour_Decoder.get_time_value().val != now.hour.val) {
+                        Hour_Decoder.advance_tick();
+                    }
+
+                    if (now.hour.val == 0x00) {
+                        if (Weekday_Decoder.get_time_value().val <= 0x07) {
+                            Weekday_Decoder.advance_tick();
+                        }
+
+                        // "while" takes automatically care of different month lengths
+                        while (Day_Decoder.get_time_value().val <= 0x31 &&
+                            Day_Decoder.get_time_value().val != now.day.val) {
+                            Day_Decoder.advance_tick();
+                        }
+
+                        if (now.day.val == 0x01) {
+                            if (Month_Decoder.get_time_value().val <= 0x12) {
+                                Month_Decoder.advance_tick();
+                            }
+                            if (now.month.val == 0x01) {
+                                if (now.year.val <= 0x99) { Year_Decoder.advance_tick(); }
+                            }
+                        }
+                    }
+                }
+            }
+
+            if (now.second == 0) {
+                // While synced the decoders expect the predicted values. Each
+                // decoder falls back to full binning for the rest of the minute
+                // on the first bit that disagrees.
+                const bool fast_path = Local_Clock.clock_state == Clock::synced;
+                Minute_Decoder.set_fast_path(fast_path);
+                Hour_Decoder.set_fast_path(fast_path);
+                Weekday_Decoder.set_fast_path(fast_path);
+                Day_Decoder.set_fast_path(fast_path);
+                Month_Decoder.set_fast_path(fast_path);
+                Year_Decoder.set_fast_path(fast_path);
+            }
+
+            const uint8_t tick_value = (tick_data == long_tick || tick_data == undefined)? 1: 0;
+            Flag_Decoder.process_tick(now.second, tick_value);
+            Minute_Decoder.process_tick(now.second, tick_value);
+            Hour_Decoder.process_tick(now.second, tick_value);
+            Weekday_Decoder.process_tick(now.second, tick_value);
+            Day_Decoder.process_tick(now.second, tick_value);
+            Month_Decoder.process_tick(now.second, tick_value);
+            Year_Decoder.process_tick(now.second, tick_value);
+
+            if (now.second == 0) {
+                // all date bits of the previous minute are binned
+                update_joint_date_quality_factor();
+            }
+        }
+
+        static Tick_History<Configuration::tick_history_minutes> History;
+
+        // Number of the most recent ticks in the history that are not yet
+        // binned. While this is not 0 the decoders lag behind.
+        static uint16_t replay_pending;
+
+        // A frame received during the replay is seeded when the replay
+        // reaches the tick the frame was received with.
+        static DCF77_Encoder replay_frame;
+        static bool replay_frame_pending;
+        static uint16_t replay_frame_age;
+
+        // Ticks replayed per received tick. This bounds the time spent
+        // in the tick handler, the history is replayed within a few seconds.
+        static const uint8_t replay_ticks_per_tick = 60;
+
+        // Bins the oldest pending ticks of the history. The most recent
+        // tick was received in second.
+        static void replay_history(const uint8_t second) {
+            for (uint8_t ticks = replay_ticks_per_tick; ticks > 0 && replay_pending > 0; --ticks) {
+                const uint16_t age = --replay_pending;
+
+                DCF77_Encoder now;
+                set_DCF77_Encoder(now);
+                // the second before the tick, advance_second handles the minute rollover
+                now.second = (second + 119 - age % 60) % 60;
+                if (now.second == 59) {
+                    // flush() takes over the minute at the start of second 0
+                    decoded_time = now;
+                    decoded_time.second = 0;
+                }
+                now.advance_second();
+                bin_tick(now, History.get(age));
+
+                if (replay_frame_pending && age == replay_frame_age) {
+                    seed_decoders(replay_frame);
+                    replay_frame_pending = false;
+                }
+            }
+        }
+
+        // Until the clock is locked the second decoder may change the
+        // alignment of the minute. All ticks binned so far were then
+        // attributed to the wrong bits, hence the decoders are reset and
+        // the history is replayed. expected_second is the second the most
+        // recent tick was binned with.
+        static void rebin_on_shift(const uint8_t expected_second) {
+            const uint8_t second = Second_Decoder.get_time_value();
+            if (History.count > 0 && second < 60 && second != expected_second &&
+                leap_second == 0 && restore_state == restore_idle &&
+                Local_Clock.clock_state != Clock::locked &&
+                Local_Clock.clock_state != Clock::synced) {
+                joint_date_quality_factor = 0;
+                Flag_Decoder.setup();
+                Minute_Decoder.setup();
+                Hour_Decoder.setup();
+                Weekday_Decoder.setup();
+                Day_Decoder.setup();
+                Month_Decoder.setup();
+                Year_Decoder.setup();
+                replay_pending = History.count;
+                replay_frame_pending = false;
+            }
         }
 
         // This is the callback of the Demodulator stage. The clock controller
@@ -1884,51 +3595,40 @@ namespace Internal {
             // leap_second == 1 indicates that we now process second 59 but not the expected sync mark
             leap_second += (now.second == 59 && now.get_current_signal() != sync_mark);
 
-            if (leap_second != 1) {
-                Second_Decoder.binning(tick_data);
-
-                if (now.second == 0) {
-                    Minute_Decoder.advance_tick();
-                    if (now.minute.val == 0x00) {
-
-                        // "while" takes automatically care of timezone change
-                        while (Hour_Decoder.get_time_value().val <= 0x23 &&
-                            Hour_Decoder.get_time_value().val != now.hour.val) {
-                            Hour_Decoder.advance_tick();
-                        }
+            Monitor::on_second_tick(now.second, tick_data);
+            ++statistics.ticks[tick_data];
+            statistics.leap_seconds += (leap_second == 1);
+            Trace.record(tick_data, now.second, Demodulator.signal_max_index,
+                         Local_Clock.clock_state, carrier_absent, Local_Clock.tick,
+                         (const uint8_t *)&diagnostics[diagnostics_generation & 1].quality_factor);
 
-                        if (now.hour.val == 0x00) {
-                            if (Weekday_Decoder.get_time_value().val <= 0x07) {
-                                Weekday_Decoder.advance_tick();
-                            }
+            if (leap_second != 1 && !decoders_frozen && !carrier_absent) {
+                Second_Decoder.binning(tick_data);
+                History.push(tick_data);
+                ++replay_frame_age;
 
-                            // "while" takes automatically care of different month lengths
-                            while (Day_Decoder.get_time_value().val <= 0x31 &&
-                                Day_Decoder.get_time_value().val != now.day.val) {
-                                Day_Decoder.advance_tick();
-                            }
+                if (replay_pending > 0 && replay_pending < History.count) {
+                    // the tick is binned as part of the replay
+                    ++replay_pending;
+                }
+                rebin_on_shift(now.second);
 
-                            if (now.day.val == 0x01) {
-                                if (Month_Decoder.get_time_value().val <= 0x12) {
-                                    Month_Decoder.advance_tick();
-                                }
-                                if (now.month.val == 0x01) {
-                                    if (now.year.val <= 0x99) { Year_Decoder.advance_tick(); }
-                                }
-                            }
-                        }
-                    }
+                if (replay_pending == 0) {
+                    bin_tick(now, tick_data);
+                } else if (Second_Decoder.get_time_value() < 60) {
+                    replay_history(Second_Decoder.get_time_value());
+                } else {
+                    // second decoder lost its lock, the next lock will trigger a new replay
+                    replay_pending = 0;
+                    replay_frame_pending = false;
                 }
+            }
 
-                const uint8_t tick_value = (tick_data == long_tick || tick_data == undefined)? 1: 0;
-                Flag_Decoder.process_tick(now.second, tick_value);
-                Minute_Decoder.process_tick(now.second, tick_value);
-                Hour_Decoder.process_tick(now.second, tick_value);
-                Weekday_Decoder.process_tick(now.second, tick_value);
-                Day_Decoder.process_tick(now.second, tick_value);
-                Month_Decoder.process_tick(now.second, tick_value);
-                Year_Decoder.process_tick(now.second, tick_value);
+            if (Frame_Decoder.process_tick(tick_data)) {
+                process_frame(Frame_Decoder.frame);
             }
+            process_restore();
+            process_hint();
         }
 
 
@@ -1953,6 +3653,9 @@ namespace Internal {
         } clock_quality_t;
 
         static void get_quality(clock_quality_t &clock_quality) {
+            clock_quality.clock_state      = get_clock_state();
+            clock_quality.prediction_match = get_prediction_match();
+
             Demodulator.get_quality(clock_quality.phase);
             Second_Decoder.get_quality(clock_quality.second);
             Minute_Decoder.get_quality(clock_quality.minute);
@@ -1990,18 +3693,28 @@ namespace Internal {
         }
 
         static uint8_t get_overall_quality_factor() {
+            clock_quality_factor_t clock_quality_factor;
+            get_quality_factor(clock_quality_factor);
+
+            return get_overall_quality_factor(clock_quality_factor);
+        }
+
+        static uint8_t get_overall_quality_factor(const clock_quality_factor_t &clock_quality_factor) {
             using namespace Arithmetic_Tools;
 
-            uint8_t quality_factor = Demodulator.get_quality_factor();
-            minimize(quality_factor, Second_Decoder.get_quality_factor());
-            minimize(quality_factor, Minute_Decoder.get_quality_factor());
-            minimize(quality_factor, Hour_Decoder.get_quality_factor());
+            uint8_t quality_factor = clock_quality_factor.phase;
+            minimize(quality_factor, clock_quality_factor.second);
+            minimize(quality_factor, clock_quality_factor.minute);
+            minimize(quality_factor, clock_quality_factor.hour);
+
+            uint8_t date_quality_factor = clock_quality_factor.day;
+            minimize(date_quality_factor, clock_quality_factor.month);
+            minimize(date_quality_factor, clock_quality_factor.year);
 
-            uint8_t date_quality_factor = Day_Decoder.get_quality_factor();
-            minimize(date_quality_factor, Month_Decoder.get_quality_factor());
-            minimize(date_quality_factor, Year_Decoder.get_quality_factor());
+            // the joint date stage may be more confident than the weakest decoder
+            maximize(date_quality_factor, joint_date_quality_factor);
 
-            const uint8_t weekday_quality_factor = Weekday_Decoder.get_quality_factor();
+            const uint8_t weekday_quality_factor = clock_quality_factor.weekday;
             if (date_quality_factor > 0 && weekday_quality_factor > 0) {
 
                 DCF77_Encoder now;
@@ -2025,9 +3738,124 @@ namespace Internal {
             }
 
             minimize(quality_factor, date_quality_factor);
-            return quality_factor;
+
+            // restored decoders may be off by one minute until the second
+            // decoder has confirmed the phase of the minute, replaying
+            // decoders lag behind the current minute and frozen decoders
+            // do not follow the time at all
+            return restore_state == restore_idle && replay_pending == 0 && !decoders_frozen? quality_factor: 0;
         };
 
+        typedef struct {
+            clock_quality_t        quality;
+            clock_quality_factor_t quality_factor;
+            uint8_t                overall_quality_factor;
+        } clock_diagnostics_t;
+
+        // The diagnostics are published once per second by the interrupt handler.
+        // The generation counter selects the current buffer, the other buffer
+        // is the one that will be written next. Thus readers need not block
+        // the interrupts, they only retry if a new second was published
+        // while they were copying.
+        static clock_diagnostics_t diagnostics[2];
+        static volatile uint8_t diagnostics_generation;
+
+        static void publish_diagnostics() {
+            clock_diagnostics_t &next = diagnostics[(diagnostics_generation + 1) & 1];
+
+            get_quality(next.quality);
+            get_quality_factor(next.quality_factor);
+            next.overall_quality_factor = get_overall_quality_factor(next.quality_factor);
+            update_lock_timeline(next.quality_factor);
+
+            // ensure the buffer is completely written before it is published
+            __asm__ __volatile__ ("" ::: "memory");
+            ++diagnostics_generation;
+        }
+
+        // non-blocking, reads the diagnostics of the last second
+        static void read_diagnostics(clock_diagnostics_t &clock_diagnostics) {
+            uint8_t generation;
+            do {
+                generation = diagnostics_generation;
+                __asm__ __volatile__ ("" ::: "memory");
+                clock_diagnostics = diagnostics[generation & 1];
+                __asm__ __volatile__ ("" ::: "memory");
+            } while (generation != diagnostics_generation);
+        }
+
+        // uptime in seconds when the quality factor of a stage exceeded
+        // quality_factor_sync_threshold for the first time, 0 = not yet
+        typedef struct {
+            uint32_t phase;
+            uint32_t second;
+            uint32_t minute;
+            uint32_t hour;
+            uint32_t weekday;
+            uint32_t day;
+            uint32_t month;
+            uint32_t year;
+        } lock_timeline_t;
+
+        typedef struct {
+            uint32_t uptime_seconds;
+            uint32_t ticks[4];  // indexed by DCF77::tick_t
+            uint32_t seconds_in_state[Clock::synced + 1];  // indexed by Clock::clock_state_t
+
+            uint16_t phase_lost_events;
+            uint16_t sync_lost_events;
+            uint16_t decoder_resets;
+            uint16_t leap_seconds;
+            uint16_t carrier_lost_events;
+
+            lock_timeline_t first_lock;
+        } clock_statistics_t;
+
+        // The counters only ever increase, they are updated
+        // by the interrupt handler without any locking.
+        static volatile clock_statistics_t statistics;
+        static uint16_t statistics_ms;
+
+        static void reset_statistics() {
+            CRITICAL_SECTION {
+                memset((void *)&statistics, 0, sizeof(statistics));
+                statistics_ms = 0;
+            }
+        }
+
+        static void count_seconds() __attribute__((always_inline)) {
+            if (++statistics_ms >= 1000) {
+                statistics_ms = 0;
+                ++statistics.uptime_seconds;
+                ++statistics.seconds_in_state[Local_Clock.clock_state];
+            }
+        }
+
+        static void update_lock_timeline(const clock_quality_factor_t &clock_quality_factor) {
+            const uint8_t threshold = Configuration::quality_factor_sync_threshold;
+            const uint32_t now = statistics.uptime_seconds;
+            volatile lock_timeline_t &first_lock = statistics.first_lock;
+
+            if (!first_lock.phase   && clock_quality_factor.phase   > threshold) { first_lock.phase   = now; }
+            if (!first_lock.second  && clock_quality_factor.second  > threshold) { first_lock.second  = now; }
+            if (!first_lock.minute  && clock_quality_factor.minute  > threshold) { first_lock.minute  = now; }
+            if (!first_lock.hour    && clock_quality_factor.hour    > threshold) { first_lock.hour    = now; }
+            if (!first_lock.weekday && clock_quality_factor.weekday > threshold) { first_lock.weekday = now; }
+            if (!first_lock.day     && clock_quality_factor.day     > threshold) { first_lock.day     = now; }
+            if (!first_lock.month   && clock_quality_factor.month   > threshold) { first_lock.month   = now; }
+            if (!first_lock.year    && clock_quality_factor.year    > threshold) { first_lock.year    = now; }
+        }
+
+        // non-blocking, copies the statistics until two consecutive
+        // copies match, thus the result is consistent
+        static void read_statistics(clock_statistics_t &clock_statistics) {
+            clock_statistics_t verify;
+            do {
+                memcpy(&clock_statistics, (const void *)&statistics, sizeof(clock_statistics));
+                memcpy(&verify,           (const void *)&statistics, sizeof(verify));
+            } while (memcmp(&clock_statistics, &verify, sizeof(verify)));
+        }
+
         static Clock::clock_state_t get_clock_state() {
             return Local_Clock.get_state();
         }
@@ -2048,9 +3876,78 @@ namespace Internal {
             }
         };
 
+        // While the demodulator detects no carrier neither flush() nor the
+        // binning take place. Thus the local clock coasts, gets unlocked
+        // after one second and the decoders are frozen with their evidence.
+        static bool carrier_absent;
+
+        static void carrier_lost_event_handler() {
+            ++statistics.carrier_lost_events;
+            carrier_absent = true;
+        }
+
+        static void carrier_regained_event_handler() {
+            carrier_absent = false;
+        }
+
+        // While the local clock is unlocked the decoders are frozen instead
+        // of reset. Received ticks are ignored until the phase returns.
+        static bool decoders_frozen;
+
         static void phase_lost_event_handler() {
+            ++statistics.phase_lost_events;
+
+            decoders_frozen = true;
+            restore_state = restore_idle;
+            hint_pending = 0;
+            History.setup();
+            replay_pending = 0;
+            replay_frame_pending = false;
+            Frame_Decoder.setup();
+        }
+
+        // The phase returned before the local clock drifted away. The local
+        // clock kept the time, hence the frozen decoders are rotated by the
+        // seconds that elapsed meanwhile. current_time is the second that
+        // starts now.
+        static void phase_regained_event_handler(const DCF77_Encoder &current_time) {
+            if (decoders_frozen) {
+                // the decoders report the second of the previous tick and
+                // the data of the next minute
+                DCF77_Encoder decoder_time = current_time;
+                for (uint8_t second = 0; second < 59; ++second) {
+                    decoder_time.advance_second();
+                }
+                resume_decoders(decoder_time);
+                decoded_time = current_time;
+            }
+        }
+
+        static void resume_decoders(const DCF77_Encoder &decoder_time) {
+            align_decoders(decoder_time);
+            leap_second = 0;
+            decoders_frozen = false;
+        }
+
+        // The frozen decoder state is of no use anymore. Either the local
+        // clock is free running or the phase returned at an unexpected offset.
+        static void decoders_stale_event_handler() {
+            if (decoders_frozen) {
+                reset_decoders();
+            }
+        }
+
+        static void reset_decoders() {
             // do not reset frequency control as a reset would also reset
             // the current value for the measurement period length
+            decoders_frozen = false;
+            restore_state = restore_idle;
+            hint_pending = 0;
+            joint_date_quality_factor = 0;
+            History.setup();
+            replay_pending = 0;
+            replay_frame_pending = false;
+            Frame_Decoder.setup();
             Second_Decoder.setup();
             Minute_Decoder.setup();
             Hour_Decoder.setup();
@@ -2073,36 +3970,58 @@ namespace Internal {
 
         static void sync_lost_event_handler() {
             Frequency_Control::unqualify_calibration();
+            ++statistics.sync_lost_events;
 
-            bool reset_successors = (Demodulator.get_quality_factor() == 0);
-            if (reset_successors) {
-                Second_Decoder.setup();
-            }
+            reset_unreliable_decoders();
+        }
 
-            reset_successors |= (Second_Decoder.get_quality_factor() == 0);
+        // With annealed weights the decoders bin with double gain while
+        // their evidence is still weak.
+        static void set_binning_schedule() {
+            const bool annealed = Configuration::binning_schedule == Configuration::annealed_weights;
+            Minute_Decoder.set_annealed(annealed);
+            Hour_Decoder.set_annealed(annealed);
+            Weekday_Decoder.set_annealed(annealed);
+            Day_Decoder.set_annealed(annealed);
+            Month_Decoder.set_annealed(annealed);
+            Year_Decoder.set_annealed(annealed);
+        }
+
+        // A poor phase does not reset the decoders. If the phase gets lost
+        // the local clock will freeze them until it returns.
+        static void reset_unreliable_decoders() {
+            bool reset_successors = (Second_Decoder.get_quality_factor() == 0);
             if (reset_successors) {
                 Minute_Decoder.setup();
+                ++statistics.decoder_resets;
             }
 
             reset_successors |= (Minute_Decoder.get_quality_factor() == 0);
             if (reset_successors) {
                 Hour_Decoder.setup();
+                ++statistics.decoder_resets;
             }
 
             reset_successors |= (Hour_Decoder.get_quality_factor() == 0);
             if (reset_successors) {
                 Weekday_Decoder.setup();
                 Day_Decoder.setup();
+                statistics.decoder_resets += 2;
             }
 
             reset_successors |= (Day_Decoder.get_quality_factor() == 0);
             if (reset_successors) {
                 Month_Decoder.setup();
+                ++statistics.decoder_resets;
             }
 
             reset_successors |= (Month_Decoder.get_quality_factor() == 0);
             if (reset_successors) {
                 Year_Decoder.setup();
+                ++statistics.decoder_resets;
+                // at least one date decoder was reset, thus the joint
+                // date quality does no longer apply
+                joint_date_quality_factor = 0;
             }
         }
 
@@ -2122,13 +4041,625 @@ namespace Internal {
         // this is slow and messes with the interrupt flag, do not call during interrupt handling
         static void auto_persist() {
             Frequency_Control::auto_persist();
+
+            uint32_t uptime;
+            CRITICAL_SECTION {
+                uptime = statistics.uptime_seconds;
+            }
+            if (Configuration::want_eeprom_snapshot &&
+                get_clock_state() == Clock::synced &&
+                uptime - last_snapshot_uptime >= Configuration::snapshot_interval) {
+                persist_snapshot();
+                last_snapshot_uptime = uptime;
+            }
         }
         #endif
 
         static void setup() {
             Demodulator.setup();
-            phase_lost_event_handler();
+            carrier_absent = true;
+            Local_Clock.setup();
+            reset_decoders();
+            set_binning_schedule();
             Frequency_Control::setup();
+            reset_statistics();
+            Trace.setup();
+            // readers and the trace must not see the diagnostics of the previous run
+            publish_diagnostics();
+        }
+
+        static Trace_Recorder<Configuration::trace_length> Trace;
+
+        // Decoder state for warm restarts. The demodulator phase bins and
+        // the second decoder are not part of the snapshot because after a
+        // restart the phase of the 1 kHz generator is unrelated to the saved
+        // phase. The frequency adjustment is persisted by the frequency control.
+        static const uint8_t snapshot_version = 1;
+        typedef struct {
+            uint8_t  version;
+            uint16_t size;
+            Clock::clock_state_t clock_state;
+            DCF77_Encoder decoder_time;  // the time as reported by the decoders
+
+            minute_decoder_t      minute;
+            hour_decoder_t        hour;
+            DCF77_Weekday_Decoder weekday;
+            DCF77_Day_Decoder     day;
+            DCF77_Month_Decoder   month;
+            DCF77_Year_Decoder    year;
+            DCF77_Flag_Decoder    flags;
+
+            uint16_t checksum;
+        } snapshot_t;
+
+        static uint16_t get_snapshot_checksum(const snapshot_t &snapshot) {
+            uint8_t sum_1 = 0;
+            uint8_t sum_2 = 0;
+            const uint8_t *data = (const uint8_t *)&snapshot;
+            // snapshot_t is not standard layout, thus no offsetof
+            const uint16_t size = (const uint8_t *)&snapshot.checksum - data;
+            for (uint16_t index = 0; index < size; ++index) {
+                Telemetry::checksum_add(sum_1, sum_2, data[index]);
+            }
+            return (uint16_t)sum_2 << 8 | sum_1;
+        }
+
+        static void save_snapshot(snapshot_t &snapshot) {
+            memset((void *)&snapshot, 0, sizeof(snapshot));
+            snapshot.version = snapshot_version;
+            snapshot.size = sizeof(snapshot_t);
+
+            CRITICAL_SECTION {
+                snapshot.clock_state = Local_Clock.clock_state;
+                set_DCF77_Encoder(snapshot.decoder_time);
+
+                snapshot.minute  = Minute_Decoder;
+                snapshot.hour    = Hour_Decoder;
+                snapshot.weekday = Weekday_Decoder;
+                snapshot.day     = Day_Decoder;
+                snapshot.month   = Month_Decoder;
+                snapshot.year    = Year_Decoder;
+                snapshot.flags   = Flag_Decoder;
+            }
+
+            snapshot.checksum = get_snapshot_checksum(snapshot);
+        }
+
+        // rotates the decoder bins such that they will report decoder_time
+        static void align_decoders(const DCF77_Encoder &decoder_time) {
+            BCD::bcd_t digit;
+
+            Second_Decoder.align(decoder_time.second);
+            Minute_Decoder.align(decoder_time.minute);
+            Hour_Decoder.align(decoder_time.hour);
+            Weekday_Decoder.align(decoder_time.weekday);
+            Day_Decoder.align(decoder_time.day);
+            Month_Decoder.align(decoder_time.month);
+
+            digit.val = decoder_time.year.digit.lo;
+            Year_Decoder.align(digit);
+            digit.val = decoder_time.year.digit.hi;
+            Year_Decoder.Decade_Decoder.align(digit);
+        }
+
+        // After a restart the age of a snapshot is only known up to the
+        // resolution of the RTC and the phase of the second is unknown.
+        // Hence the second decoder starts from scratch and the other decoders
+        // are realigned as soon as it has found the phase of the minute. To
+        // this end restored_time runs 30 seconds behind the expected time.
+        // Sync is blocked until the next minute after the realignment, which
+        // is when flush() takes over the minute of the restored decoders.
+        typedef enum { restore_idle, restore_waiting, restore_aligned } restore_state_t;
+        static DCF77_Encoder restored_time;
+        static uint8_t restore_delay;
+        static restore_state_t restore_state;
+
+        // Restores a snapshot that was saved age_seconds ago, call after setup().
+        static bool restore_snapshot(const snapshot_t &snapshot, const uint32_t age_seconds) {
+            if (snapshot.version != snapshot_version ||
+                snapshot.size    != sizeof(snapshot_t) ||
+                snapshot.checksum != get_snapshot_checksum(snapshot) ||
+                snapshot.clock_state != Clock::synced ||
+                age_seconds > Configuration::max_snapshot_age) {
+                return false;
+            }
+
+            DCF77_Encoder decoder_time = snapshot.decoder_time;
+            const uint32_t lag = age_seconds < 30? 0: age_seconds - 30;
+            for (uint32_t minute = 0; minute < lag / 60; ++minute) {
+                decoder_time.advance_minute();
+            }
+            for (uint8_t second = 0; second < lag % 60; ++second) {
+                decoder_time.advance_second();
+            }
+
+            CRITICAL_SECTION {
+                Minute_Decoder  = snapshot.minute;
+                Hour_Decoder    = snapshot.hour;
+                Weekday_Decoder = snapshot.weekday;
+                Day_Decoder     = snapshot.day;
+                Month_Decoder   = snapshot.month;
+                Year_Decoder    = snapshot.year;
+                Flag_Decoder    = snapshot.flags;
+                Second_Decoder.setup();
+
+                // best guess until the second decoder has locked
+                restored_time = decoder_time;
+                for (uint8_t second = lag? 30: age_seconds; second > 0; --second) {
+                    decoder_time.advance_second();
+                }
+                align_decoders(decoder_time);
+
+                restore_delay = lag? 0: 30 - age_seconds;
+                restore_state = restore_waiting;
+            }
+            return true;
+        }
+
+        static void process_restore() {
+            if (restore_state == restore_waiting) {
+                if (restore_delay) {
+                    --restore_delay;
+                } else {
+                    restored_time.advance_second();
+
+                    if (Second_Decoder.get_quality_factor() > Configuration::quality_factor_sync_threshold + 1) {
+                        // pick the time closest to the expected time that
+                        // matches the second reported by the second decoder
+                        const uint8_t second = Second_Decoder.get_time_value();
+                        if (second < 60) {
+                            while (restored_time.second != second) {
+                                restored_time.advance_second();
+                            }
+                            align_decoders(restored_time);
+                        }
+                        restore_state = restore_aligned;
+                    }
+                }
+            }
+        }
+
+        static void seed_decoders(const DCF77_Encoder &frame) {
+            const uint8_t weight = Configuration::frame_weight;
+            BCD::bcd_t digit;
+
+            Minute_Decoder.seed(frame.minute, weight);
+            Hour_Decoder.seed(frame.hour, weight);
+            Weekday_Decoder.seed(frame.weekday, weight);
+            Day_Decoder.seed(frame.day, weight);
+            Month_Decoder.seed(frame.month, weight);
+
+            digit.val = frame.year.digit.lo;
+            Year_Decoder.seed(digit, weight);
+            digit.val = frame.year.digit.hi;
+            Year_Decoder.Decade_Decoder.seed(digit, weight);
+        }
+
+        // A frame that passed all checks of the frame decoder is strong
+        // evidence. Until the clock gets locked each such frame will give
+        // the decoders a head start. Afterwards only the binning counts.
+        // This is called right after the sync mark, thus the decoders still
+        // decode the data of this frame.
+        static void process_frame(const DCF77_Encoder &frame) {
+            if (Local_Clock.clock_state != Clock::locked &&
+                Local_Clock.clock_state != Clock::synced && !decoders_frozen) {
+                const uint8_t second = Second_Decoder.get_time_value();
+                Second_Decoder.seed(59, Configuration::frame_weight);
+                rebin_on_shift(second);
+
+                if (replay_pending == 0) {
+                    seed_decoders(frame);
+                } else {
+                    // the decoders still hold the data of an older minute
+                    replay_frame = frame;
+                    replay_frame_pending = true;
+                    replay_frame_age = 0;
+                }
+
+                if (Second_Decoder.prediction_match == DCF77_Second_Decoder::convolution_binning_not_ready) {
+                    // the frame holds the data of the next minute
+                    Second_Decoder.set_convolution_time(frame);
+                }
+            }
+        }
+
+        // The date decoders lock independently, however the date is
+        // constrained by the calendar. The joint date stage scores a date
+        // with the bins of its day, month, year and decade, the weekday bin
+        // of its weekday and the received date parity. The date of the
+        // decoders is compared against the best valid date that differs in
+        // one field and against an upper bound for dates that differ in more
+        // fields. The margin gives the joint quality factor.
+        static uint8_t joint_date_quality_factor;
+
+        // Score of the date the given bins map to. Returns false if the date
+        // does not exist.
+        static bool get_joint_date_score(const uint8_t day, const uint8_t month,
+                                         const uint8_t year, const uint8_t decade, uint16_t &score) {
+            using namespace Arithmetic_Tools;
+
+            DCF77_Encoder date;
+            date.day   = Day_Decoder.get_bin_value(day);
+            date.month = Month_Decoder.get_bin_value(month);
+            date.year.val = Year_Decoder.get_bin_value(year).val +
+                            (Year_Decoder.Decade_Decoder.get_bin_value(decade).val << 4);
+
+            if (BCD::bcd_to_int(date.day) > date.days_per_month()) {
+                return false;
+            }
+
+            const BCD::bcd_t weekday = date.get_bcd_weekday();
+            const bool date_parity = parity(date.day.val) ^ parity(weekday.val) ^
+                                     parity(date.month.val) ^ parity(date.year.val);
+
+            score = Day_Decoder.data[day] +
+                    Month_Decoder.data[month] +
+                    Year_Decoder.data[year] +
+                    Year_Decoder.Decade_Decoder.data[decade] +
+                    Weekday_Decoder.data[Weekday_Decoder.get_bin_index(weekday)];
+            const int8_t parity_score = date_parity? Flag_Decoder.date_parity: -Flag_Decoder.date_parity;
+            if (parity_score > 0) {
+                score += parity_score;
+            }
+            return true;
+        }
+
+        static void update_joint_date_quality_factor() {
+            using namespace Arithmetic_Tools;
+
+            joint_date_quality_factor = 0;
+            if (Day_Decoder.signal_max_index     >= 31 ||
+                Month_Decoder.signal_max_index   >= 12 ||
+                Year_Decoder.signal_max_index    >= 10 ||
+                Year_Decoder.Decade_Decoder.signal_max_index >= 10 ||
+                Weekday_Decoder.signal_max_index >=  7) {
+                return;
+            }
+
+            DCF77_Encoder date;
+            date.day   = Day_Decoder.get_time_value();
+            date.month = Month_Decoder.get_time_value();
+            date.year  = Year_Decoder.get_time_value();
+            if (date.day.val > 0x31 || date.month.val > 0x12 || date.year.val > 0x99 ||
+                Weekday_Decoder.get_time_value().val != date.get_bcd_weekday().val) {
+                return;
+            }
+
+            // day, month, year, decade
+            const uint8_t bins[4]  = { 31, 12, 10, 10 };
+            const uint8_t index[4] = { Day_Decoder.signal_max_index,
+                                       Month_Decoder.signal_max_index,
+                                       Year_Decoder.signal_max_index,
+                                       Year_Decoder.Decade_Decoder.signal_max_index };
+
+            uint16_t best_score;
+            if (!get_joint_date_score(index[0], index[1], index[2], index[3], best_score)) {
+                return;
+            }
+
+            // best valid date that differs in one field
+            uint16_t runner_up_score = 0;
+            for (uint8_t field = 0; field < 4; ++field) {
+                uint8_t alternative[4] = { index[0], index[1], index[2], index[3] };
+                for (uint8_t bin = 0; bin < bins[field]; ++bin) {
+                    if (bin != index[field]) {
+                        alternative[field] = bin;
+                        uint16_t score;
+                        if (get_joint_date_score(alternative[0], alternative[1], alternative[2], alternative[3], score)) {
+                            maximize(runner_up_score, score);
+                        }
+                    }
+                }
+            }
+
+            // A date that differs in more fields loses at least the two
+            // smallest gaps between the strongest and the runner up bins.
+            // At best it gains the strongest weekday bin and the parity.
+            const uint8_t gaps[4] = {
+                (uint8_t)(Day_Decoder.data[index[0]]   - Day_Decoder.data[Day_Decoder.get_runner_up_index()]),
+                (uint8_t)(Month_Decoder.data[index[1]] - Month_Decoder.data[Month_Decoder.get_runner_up_index()]),
+                (uint8_t)(Year_Decoder.data[index[2]]  - Year_Decoder.data[Year_Decoder.get_runner_up_index()]),
+                (uint8_t)(Year_Decoder.Decade_Decoder.data[index[3]] -
+                          Year_Decoder.Decade_Decoder.data[Year_Decoder.Decade_Decoder.get_runner_up_index()])
+            };
+            uint8_t smallest_gap = 255;
+            uint8_t second_smallest_gap = 255;
+            for (uint8_t field = 0; field < 4; ++field) {
+                if (gaps[field] < smallest_gap) {
+                    second_smallest_gap = smallest_gap;
+                    smallest_gap = gaps[field];
+                } else {
+                    minimize(second_smallest_gap, gaps[field]);
+                }
+            }
+            const uint16_t fields_score = Day_Decoder.data[index[0]] + Month_Decoder.data[index[1]] +
+                                          Year_Decoder.data[index[2]] + Year_Decoder.Decade_Decoder.data[index[3]];
+            const uint16_t parity_score = Flag_Decoder.date_parity < 0? -Flag_Decoder.date_parity: Flag_Decoder.date_parity;
+            maximize(runner_up_score, (uint16_t)(fields_score - smallest_gap - second_smallest_gap +
+                                                 Weekday_Decoder.data[Weekday_Decoder.signal_max_index] + parity_score));
+
+            if (runner_up_score >= best_score) {
+                return;
+            }
+
+            // delta / ld(max + 3), similar to the quality factor of the bins
+            uint8_t log2 = 0;
+            for (uint16_t max = best_score + 3; max > 1; max >>= 1) {
+                ++log2;
+            }
+            const uint16_t quality_factor = (best_score - runner_up_score) / log2;
+            joint_date_quality_factor = quality_factor < 255? quality_factor: 255;
+        }
+
+        // An external time hint, e.g. from an RTC, is not trusted blindly.
+        // Whenever a decoder starts to decode the hinted value on its own
+        // the hint will add weight to this value. Thus a wrong hint is
+        // just ignored. The comparison happens in the middle of the minute
+        // where an error of the hint of a few seconds does not matter.
+        typedef enum {
+            hint_minute  = 0x01,
+            hint_hour    = 0x02,
+            hint_weekday = 0x04,
+            hint_day     = 0x08,
+            hint_month   = 0x10,
+            hint_year    = 0x20,
+            hint_decade  = 0x40
+        } hint_t;
+        static DCF77_Encoder hint_time;
+        static uint8_t hint_pending;  // set of hint_t
+        static uint8_t hint_minutes;  // minutes left till the hint expires
+
+        // call after setup()
+        static void set_time_hint(const DCF77_Encoder &time, const uint32_t uncertainty_seconds) {
+            // the decoders will always decode the data for the NEXT minute
+            DCF77_Encoder decoder_time = time;
+            decoder_time.advance_minute();
+
+            uint8_t pending = 0;
+            if (uncertainty_seconds < 30) {
+                pending |= hint_minute;
+            }
+            if (uncertainty_seconds < 30UL*60) {
+                pending |= hint_hour;
+            }
+            if (uncertainty_seconds < 12UL*60*60) {
+                pending |= hint_weekday | hint_day | hint_month | hint_year | hint_decade;
+            }
+
+            CRITICAL_SECTION {
+                hint_time = decoder_time;
+                hint_pending = pending;
+                hint_minutes = Configuration::time_hint_minutes;
+            }
+        }
+
+        template <typename decoder_t>
+        static void process_hint(decoder_t &decoder, const hint_t hint, const BCD::bcd_t value) {
+            if ((hint_pending & hint) && decoder.get_time_value().val == value.val) {
+                decoder.seed(value, Configuration::time_hint_weight);
+                hint_pending &= ~hint;
+            }
+        }
+
+        static void process_hint() {
+            if (hint_pending) {
+                hint_time.advance_second();
+
+                if (hint_time.second == 30) {
+                    BCD::bcd_t digit;
+
+                    process_hint(Minute_Decoder,  hint_minute,  hint_time.minute);
+                    process_hint(Hour_Decoder,    hint_hour,    hint_time.hour);
+                    process_hint(Weekday_Decoder, hint_weekday, hint_time.weekday);
+                    process_hint(Day_Decoder,     hint_day,     hint_time.day);
+                    process_hint(Month_Decoder,   hint_month,   hint_time.month);
+
+                    digit.val = hint_time.year.digit.lo;
+                    process_hint(static_cast<Binning::Decoder<uint8_t, 10> &>(Year_Decoder), hint_year, digit);
+                    digit.val = hint_time.year.digit.hi;
+                    process_hint(Year_Decoder.Decade_Decoder, hint_decade, digit);
+
+                    if (--hint_minutes == 0) {
+                        hint_pending = 0;
+                    }
+                }
+            }
+        }
+
+        #if defined(_AVR_EEPROM_H_)
+        typedef bool assert_snapshot_fits_into_eeprom_region[
+            sizeof(snapshot_t) <= Configuration::snapshot_eeprom_size? 1: -1];
+        static uint32_t last_snapshot_uptime;
+
+        // this is slow, do not call during interrupt handling
+        static void persist_snapshot() {
+            snapshot_t snapshot;
+            save_snapshot(snapshot);
+            // update will only write the bytes that changed
+            eeprom_update_block(&snapshot, (void *)Configuration::snapshot_eeprom_base, sizeof(snapshot));
+        }
+
+        static bool restore_snapshot_from_eeprom(const uint32_t age_seconds) {
+            if (!Configuration::want_eeprom_snapshot) { return false; }
+
+            snapshot_t snapshot;
+            eeprom_read_block(&snapshot, (const void *)Configuration::snapshot_eeprom_base, sizeof(snapshot));
+            return restore_snapshot(snapshot, age_seconds);
+        }
+        #endif
+
+        #if defined(__unix__)
+        static bool save_snapshot_to_file(const char *file_name) {
+            snapshot_t snapshot;
+            save_snapshot(snapshot);
+
+            FILE *file = fopen(file_name, "wb");
+            if (!file) { return false; }
+            const bool ok = fwrite(&snapshot, sizeof(snapshot), 1, file) == 1;
+            return (fclose(file) == 0) && ok;
+        }
+
+        // the age is derived from the modification time of the file
+        static bool restore_snapshot_from_file(const char *file_name) {
+            struct stat file_status;
+            if (stat(file_name, &file_status) != 0) { return false; }
+            const time_t now = time(0);
+            if (now < file_status.st_mtime) { return false; }
+
+            snapshot_t snapshot;
+            FILE *file = fopen(file_name, "rb");
+            if (!file) { return false; }
+            const bool ok = fread(&snapshot, sizeof(snapshot), 1, file) == 1;
+            fclose(file);
+
+            return ok && restore_snapshot(snapshot, now - file_status.st_mtime);
+        }
+        #endif
+
+        // Replays a trace that was recorded since setup(), intended for the host.
+        // The recorded ticks are fed into the decoders and the resulting quality
+        // factors are compared against the recorded ones. The demodulator can not
+        // be replayed, hence its quality factor is not compared. The host must
+        // use the tick_history_minutes of the device (see has_memory_for_trace).
+        // Returns the index of the first record that does not match or
+        // record_count if the whole trace was reproduced.
+        static uint16_t replay_trace(const trace_record_t *records, const uint16_t record_count) {
+            setup();
+            Trace.freeze();
+
+            Clock::clock_state_t previous_state = Clock::useless;
+            // the local clock is not part of the trace, frozen decoders
+            // are advanced by the number of ticks they missed instead
+            DCF77_Encoder frozen_time;
+            for (uint16_t index = 0; index < record_count; ++index) {
+                const trace_record_t &record = records[index];
+                const Clock::clock_state_t clock_state = (Clock::clock_state_t)((record.tick_and_state >> 2) & 0x07);
+                carrier_absent = record.tick_and_state & 0x20;
+
+                // flush() takes care of leap seconds and flags,
+                // the local clock will stay useless without the demodulator
+                flush();
+
+                // replay the events that freeze, resume or reset the decoders
+                if (clock_state == Clock::unlocked &&
+                    (previous_state == Clock::locked || previous_state == Clock::synced)) {
+                    phase_lost_event_handler();
+                    set_DCF77_Encoder(frozen_time);
+                } else if (decoders_frozen && clock_state == Clock::locked) {
+                    resume_decoders(frozen_time);
+                } else if (decoders_frozen && clock_state == Clock::free) {
+                    reset_decoders();
+                } else if (previous_state == Clock::synced && clock_state != Clock::synced) {
+                    reset_unreliable_decoders();
+                }
+                previous_state = clock_state;
+
+                // usually triggered by local_clock_flush()
+                if (decoded_time.second == 15 && clock_state != Clock::useless
+                                              && clock_state != Clock::dirty) {
+                    Second_Decoder.set_convolution_time(decoded_time);
+                }
+
+                clock_quality_factor_t clock_quality_factor;
+                get_quality_factor(clock_quality_factor);
+                if (memcmp(&clock_quality_factor.second, &record.quality_factor[1], sizeof(record.quality_factor) - 1)) {
+                    return index;
+                }
+
+                // Frames, rebinning and the fast path depend on the state of
+                // the local clock when the tick was recorded. Without the
+                // demodulator the local clock has to stay useless otherwise.
+                Local_Clock.clock_state = clock_state;
+                process_single_tick_data((DCF77::tick_t)(record.tick_and_state & 0x03));
+                Local_Clock.clock_state = Clock::useless;
+                if (decoders_frozen) {
+                    frozen_time.advance_second();
+                }
+            }
+            return record_count;
+        }
+
+        static void send_diagnostics_telemetry(const Telemetry::byte_sink_t sink) {
+            clock_diagnostics_t clock_diagnostics;
+            read_diagnostics(clock_diagnostics);
+
+            const clock_quality_t        &clock_quality        = clock_diagnostics.quality;
+            const clock_quality_factor_t &clock_quality_factor = clock_diagnostics.quality_factor;
+
+            Telemetry::Encoder encoder;
+            encoder.begin(sink, Telemetry::diagnostics_frame, 36);
+            encoder.put(clock_quality.clock_state);
+            encoder.put(clock_quality.prediction_match);
+            encoder.put_32(clock_quality.phase.lock_max);
+            encoder.put_32(clock_quality.phase.noise_max);
+
+            const lock_quality_t * const stages[] = {
+                &clock_quality.second, &clock_quality.minute,  &clock_quality.hour,
+                &clock_quality.weekday, &clock_quality.day, &clock_quality.month, &clock_quality.year };
+            for (uint8_t stage = 0; stage < sizeof(stages)/sizeof(stages[0]); ++stage) {
+                encoder.put(stages[stage]->lock_max);
+                encoder.put(stages[stage]->noise_max);
+            }
+
+            encoder.put(clock_quality.uses_summertime_quality);
+            encoder.put(clock_quality.timezone_change_scheduled_quality);
+            encoder.put(clock_quality.leap_second_scheduled_quality);
+
+            encoder.put(clock_quality_factor.phase);
+            encoder.put(clock_quality_factor.second);
+            encoder.put(clock_quality_factor.minute);
+            encoder.put(clock_quality_factor.hour);
+            encoder.put(clock_quality_factor.weekday);
+            encoder.put(clock_quality_factor.day);
+            encoder.put(clock_quality_factor.month);
+            encoder.put(clock_quality_factor.year);
+            encoder.put(clock_diagnostics.overall_quality_factor);
+            encoder.end();
+        }
+
+        static void send_statistics_telemetry(const Telemetry::byte_sink_t sink) {
+            clock_statistics_t clock_statistics;
+            read_statistics(clock_statistics);
+
+            const lock_timeline_t &first_lock = clock_statistics.first_lock;
+            const uint32_t values[] = {
+                clock_statistics.uptime_seconds,
+                clock_statistics.ticks[0], clock_statistics.ticks[1],
+                clock_statistics.ticks[2], clock_statistics.ticks[3],
+                clock_statistics.seconds_in_state[Clock::useless],  clock_statistics.seconds_in_state[Clock::dirty],
+                clock_statistics.seconds_in_state[Clock::free],     clock_statistics.seconds_in_state[Clock::unlocked],
+                clock_statistics.seconds_in_state[Clock::locked],   clock_statistics.seconds_in_state[Clock::synced],
+                clock_statistics.phase_lost_events, clock_statistics.sync_lost_events,
+                clock_statistics.decoder_resets,    clock_statistics.leap_seconds,
+                first_lock.phase, first_lock.second,  first_lock.minute, first_lock.hour,
+                first_lock.weekday, first_lock.day, first_lock.month, first_lock.year,
+                clock_statistics.carrier_lost_events };
+            const uint8_t value_count = sizeof(values)/sizeof(values[0]);
+
+            uint16_t payload_length = 0;
+            for (uint8_t index = 0; index < value_count; ++index) {
+                payload_length += Telemetry::varint_length(values[index]);
+            }
+
+            Telemetry::Encoder encoder;
+            encoder.begin(sink, Telemetry::statistics_frame, payload_length);
+            for (uint8_t index = 0; index < value_count; ++index) {
+                encoder.put_varint(values[index]);
+            }
+            encoder.end();
+        }
+
+        // sends one frame per decoder and one frame for the phase bins
+        static void send_bins_telemetry(const Telemetry::byte_sink_t sink) {
+            Demodulator.send_telemetry(sink);
+            Second_Decoder.send_telemetry(sink, Telemetry::second_decoder);
+            Minute_Decoder.send_telemetry(sink, Telemetry::minute_decoder);
+            Hour_Decoder.send_telemetry(sink, Telemetry::hour_decoder);
+            Weekday_Decoder.send_telemetry(sink, Telemetry::weekday_decoder);
+            Day_Decoder.send_telemetry(sink, Telemetry::day_decoder);
+            Month_Decoder.send_telemetry(sink, Telemetry::month_decoder);
+            Year_Decoder.send_telemetry(sink, Telemetry::year_decoder);
+            Year_Decoder.Decade_Decoder.send_telemetry(sink, Telemetry::decade_decoder);
         }
 
         static void debug() {
@@ -2142,13 +4673,13 @@ namespace Internal {
             now.year    = Year_Decoder.get_time_value();
             now.debug();
 
-            clock_quality_t clock_quality;
-            get_quality(clock_quality);
+            clock_diagnostics_t clock_diagnostics;
+            read_diagnostics(clock_diagnostics);
 
-            clock_quality_factor_t clock_quality_factor;
-            get_quality_factor(clock_quality_factor);
+            const clock_quality_t        &clock_quality        = clock_diagnostics.quality;
+            const clock_quality_factor_t &clock_quality_factor = clock_diagnostics.quality_factor;
 
-            sprint(get_overall_quality_factor(), DEC);
+            sprint(clock_diagnostics.overall_quality_factor, DEC);
             sprint(F(" p("));
             sprint(clock_quality.phase.lock_max, DEC);
             sprint('-');
@@ -2220,14 +4751,14 @@ namespace Internal {
             sprint(clock_quality.leap_second_scheduled_quality, DEC);
 
             sprint(',');
-            sprintln(get_prediction_match(), DEC);
+            sprintln(clock_quality.prediction_match, DEC);
         }
     };
 
     namespace Generic_1_kHz_Generator {
         // This is the only remaining dependency to the DCF77 clock.
         // The implementation of the generator is otherwise completely generic.
-        typedef DCF77_Clock_Controller<Configuration, DCF77_Frequency_Control> Clock_Controller;
+        typedef DCF77_Clock_Controller<Configuration, DCF77_Frequency_Control, DCF77_Clock_Monitor> Clock_Controller;
 
         void setup(const Clock::input_provider_t input_provider);
         uint8_t zero_provider();
@@ -60,6 +60,7 @@ const uint8_t dcf77_signal_good_indicator_pin = ledpin(13);
 
 volatile uint16_t ms_counter = 0;
 volatile Internal::DCF77::tick_t tick = Internal::DCF77::undefined;
+volatile Clock::clock_state_t clock_state = Clock::useless;
 
 
 namespace {
@@ -130,16 +131,14 @@ namespace {
 Scope scope_1;
 Scope scope_2;
 
-uint8_t sample_input_pin() {
-    const uint8_t clock_state = DCF77_Clock::get_clock_state();
-    const uint8_t sampled_data =
-        #if defined(__AVR__)
-        dcf77_inverted_samples ^ (dcf77_analog_samples? (analogRead(dcf77_analog_sample_pin) > 200)
-                                                      : digitalRead(dcf77_sample_pin));
-        #else
-        dcf77_inverted_samples ^ digitalRead(dcf77_sample_pin);
-        #endif
+// The clock state and the samples are passed by the monitor of the clock
+// if Configuration::want_monitor_callbacks is enabled, otherwise the input
+// provider has to take care of them.
+void on_clock_state_change(const Clock::clock_state_t, const Clock::clock_state_t new_state) {
+    clock_state = new_state;
+}
 
+void monitor_sample(const uint8_t sampled_data) {
     digitalWrite(dcf77_monitor_pin, sampled_data);
     digitalWrite(dcf77_second_pulse_pin, ms_counter < 500 && clock_state >= Clock::locked);
 
@@ -170,7 +169,21 @@ uint8_t sample_input_pin() {
 
     scope_1.process_one_sample(sampled_data);
     scope_2.process_one_sample(digitalRead(dcf77_synthesized_pin));
+}
 
+uint8_t sample_input_pin() {
+    const uint8_t sampled_data =
+        #if defined(__AVR__)
+        dcf77_inverted_samples ^ (dcf77_analog_samples? (analogRead(dcf77_analog_sample_pin) > 200)
+                                                      : digitalRead(dcf77_sample_pin));
+        #else
+        dcf77_inverted_samples ^ digitalRead(dcf77_sample_pin);
+        #endif
+
+    if (!Configuration::want_monitor_callbacks) {
+        clock_state = DCF77_Clock::get_clock_state();
+        monitor_sample(sampled_data);
+    }
     return sampled_data;
 }
 
@@ -185,7 +198,6 @@ void output_handler(const Clock::time_t &decoded_time) {
     //                      blink 3s on 1s off if signal is poor
     //                      blink 1s on 3s off if signal is very poor
     //                      always off if signal is bad
-    const uint8_t clock_state = DCF77_Clock::get_clock_state();
     digitalWrite(dcf77_signal_good_indicator_pin,
                  clock_state >= Clock::locked  ? 1:
                  clock_state == Clock::unlocked? (decoded_time.second.digit.lo & 0x03) != 0:
@@ -295,6 +307,8 @@ void setup_clock() {
     DCF77_Clock::setup();
     DCF77_Clock::set_input_provider(sample_input_pin);
     DCF77_Clock::set_output_handler(output_handler);
+    Internal::DCF77_Callback_Monitor::set_clock_state_change_handler(on_clock_state_change);
+    Internal::DCF77_Callback_Monitor::set_sample_handler(monitor_sample);
 }
 
 void setup() {
@@ -68,7 +68,7 @@ uint8_t ledpin(const uint8_t led) {
 
 
 using namespace Internal;
-typedef DCF77_Clock_Controller<Configuration, DCF77_Frequency_Control> Clock_Controller;
+typedef DCF77_Clock_Controller<Configuration, DCF77_Frequency_Control, DCF77_Clock_Monitor> Clock_Controller;
 
 
 namespace Phase_Drift_Analysis {
@@ -444,14 +444,9 @@ void set_mode(const char mode) {
 }
 char get_mode() { return mode; }
 
-uint8_t sample_input_pin() {
-    const uint8_t sampled_data =
-    #if defined(__AVR__)
-        dcf77_inverted_samples ^ (dcf77_analog_samples? (analogRead(dcf77_analog_sample_pin) > 200)
-                                                      : digitalRead(dcf77_sample_pin));
-    #else
-        dcf77_inverted_samples ^ digitalRead(dcf77_sample_pin);
-    #endif
+// Set as sample monitor of the clock if Configuration::want_monitor_callbacks
+// is enabled, otherwise called by the input provider.
+void monitor_sample(const uint8_t sampled_data) {
     // computations must be before display code
     Scope::process_one_sample(sampled_data);
     Phase_Drift_Analysis::process_one_sample(sampled_data);
@@ -465,7 +460,20 @@ uint8_t sample_input_pin() {
     if (mode == 'S') {
         High_Resolution_Scope::print(sampled_data);
     }
+}
 
+uint8_t sample_input_pin() {
+    const uint8_t sampled_data =
+    #if defined(__AVR__)
+        dcf77_inverted_samples ^ (dcf77_analog_samples? (analogRead(dcf77_analog_sample_pin) > 200)
+                                                      : digitalRead(dcf77_sample_pin));
+    #else
+        dcf77_inverted_samples ^ digitalRead(dcf77_sample_pin);
+    #endif
+
+    if (!Configuration::want_monitor_callbacks) {
+        monitor_sample(sampled_data);
+    }
     return sampled_data;
 }
 
@@ -661,6 +669,7 @@ void setup() {
     DCF77_Clock::setup();
     DCF77_Clock::set_input_provider(sample_input_pin);
     DCF77_Clock::set_output_handler(output_handler);
+    DCF77_Callback_Monitor::set_sample_handler(monitor_sample);
 
     Serial.println();
     Serial.print(F("DCF77 Clock V"));
@@ -5155,7 +5155,7 @@ struct modulator {
     }
 };
 
-template <boolean want_high_resolution>
+template <boolean want_high_resolution, boolean want_compact_phase_bins = false>
 struct Configuration_T {
     static const boolean want_high_phase_lock_resolution = want_high_resolution;
     //const boolean want_high_phase_lock_resolution = false;
@@ -5170,7 +5170,9 @@ struct Configuration_T {
     #endif
 
     static const boolean high_phase_lock_resolution = want_high_phase_lock_resolution &&
-                                                      has_lots_of_memory;
+                                                      (has_lots_of_memory || want_compact_phase_bins);
+
+    static const boolean compact_phase_bins = want_compact_phase_bins;
 
     enum ticks_per_second_t : uint16_t { centi_seconds = 100, milli_seconds = 1000 };
     // this is the actuall sample rate
@@ -5179,9 +5181,19 @@ struct Configuration_T {
 };
 
 
+struct Monitor_T : Internal::DCF77_No_Monitor {
+    static uint8_t tick_decisions;
+
+    static void on_tick_decision(const Internal::DCF77::tick_t) {
+        ++tick_decisions;
+    }
+};
+uint8_t Monitor_T::tick_decisions;
+
 template <typename Configuration_T>
 struct Controller_T {
     typedef Configuration_T Configuration;
+    typedef Monitor_T Monitor;
     typedef void *Controller_process_single_tick_handler(Internal::DCF77::tick_t);
 
     static Internal::DCF77::tick_t last_tick;
@@ -5189,8 +5201,16 @@ struct Controller_T {
     static void process_single_tick_data(Internal::DCF77::tick_t tick) {
         last_tick = tick;
     }
+
+    static void flush() {}
+
+    static uint8_t carrier_events;
+
+    static void carrier_lost_event_handler()     { ++carrier_events; }
+    static void carrier_regained_event_handler() { ++carrier_events; }
 };
 template <typename Configuration_T> Internal::DCF77::tick_t Controller_T<Configuration_T>::last_tick;
+template <typename Configuration_T> uint8_t Controller_T<Configuration_T>::carrier_events;
 
 template <typename Configuration_T>
 void test_Demodulator_internal() {
@@ -5267,12 +5287,17 @@ void test_Demodulator_internal() {
         decoder.set_has_tuned_clock();
         uint16_t n1 = decoder.N;
 
-        assert(F("tuning increases filter constant"), n1 == 10 * n0,
-               n1, n0);
+        if (Configuration_T::compact_phase_bins) {
+            assert(F("compact phase bins bound the tuned filter constant"), n1 == 255 && n1 > n0,
+                   n1, n0);
+        } else {
+            assert(F("tuning increases filter constant"), n1 == 10 * n0,
+                   n1, n0);
 
-        assert(F("filter constant increases according to drift improvement"),
-               n1 / n0 == Demodulator_t::tuned_ticks_to_drift_one_tick / Demodulator_t::ticks_to_drift_one_tick,
-               n1, n0);
+            assert(F("filter constant increases according to drift improvement"),
+                   n1 / n0 == Demodulator_t::tuned_ticks_to_drift_one_tick / Demodulator_t::ticks_to_drift_one_tick,
+                   n1, n0);
+        }
     }
 
     {  // phase_binning
@@ -5312,9 +5337,171 @@ void test_Demodulator_internal() {
         // no tests with noise because we will test this together with the rest of the decoder
     }
 
+    {  // sweep_phase
+        Demodulator_t decoder;
+        decoder.setup();
+        uint16_t seed = 1;
+        for (uint16_t bin = 0; bin < bin_count; ++bin) {
+            seed = seed * 75 + 74;
+            decoder.data[bin] = seed % 300;
+        }
+
+        uint32_t expected_max = 0;
+        uint16_t expected_index = 0;
+        for (uint16_t start = 0; start < bin_count; ++start) {
+            uint32_t integral = 0;
+            for (uint16_t bin = 0; bin < Demodulator_t::bins_per_200ms; ++bin) {
+                integral += (uint32_t)decoder.data[(start + bin) % bin_count] << (bin < bins_per_100ms);
+            }
+            if (integral > expected_max) {
+                expected_max = integral;
+                expected_index = start;
+            }
+        }
+
+        uint32_t max;
+        typename Demodulator_t::index_t max_index;
+        uint32_t noise_max;
+        Demodulator_t::sweep_phase(decoder.data, max, max_index, noise_max);
+        assert(F("full sweep finds the maximum of the convolution"),
+               max == expected_max && max_index == expected_index,
+               max_index,
+               expected_index);
+
+        // clean short ticks, the phase is searched without a full period
+        decoder.setup();
+        for (uint16_t bin = 0; bin < 40*bin_count + bin_count/2; ++bin) {
+            decoder.phase_binning((bin + 7) % bin_count < bins_per_100ms);
+        }
+        decoder.research_phase();
+        const uint16_t expected_phase = (bin_count + 1 - 7) % bin_count;
+        assert(F("research_phase locks on a clean short tick"),
+               decoder.signal_max_index == expected_phase && decoder.signal_max > decoder.noise_max,
+               decoder.signal_max_index,
+               expected_phase);
+    }
+
+    {  // detector_bin
+        Demodulator_t per_sample;
+        Demodulator_t per_bin;
+        per_sample.setup();
+        per_bin.setup();
+        uint16_t seed = 1;
+        for (uint16_t second = 0; second < 3; ++second) {
+            for (uint16_t bin = 0; bin < bin_count; ++bin) {
+                uint8_t ones = 0;
+                for (uint16_t sample = 0; sample < samples_per_bin; ++sample) {
+                    seed = seed * 75 + 74;
+                    const uint8_t sampled_data = (bin < bins_per_100ms) ^ (seed % 7 == 0);
+                    per_sample.detector(sampled_data);
+                    ones += sampled_data;
+                }
+                per_bin.detector_bin(ones > samples_per_bin / 2);
+            }
+        }
+        assert(F("detector_bin on averaged bins matches the per sample detector"),
+               memcmp(per_sample.data, per_bin.data, sizeof(per_bin.data)) == 0 &&
+               per_sample.tick == per_bin.tick &&
+               per_sample.signal_max_index == per_bin.signal_max_index &&
+               per_sample.stage_1.empty(),
+               per_sample.signal_max_index,
+               per_bin.signal_max_index);
+    }
+
+    if (Demodulator_t::requires_averages) {  // fine_phase
+        // the edge 3 resp. 7 samples into a bin, majority decides the phase bin
+        for (uint8_t remainder = 3; remainder < samples_per_bin; remainder += 4) {
+            Demodulator_t decoder;
+            decoder.setup();
+            for (uint32_t sample = 0; sample < 16 * (uint32_t)samples_per_second; ++sample) {
+                decoder.detector((sample + samples_per_second - 50*samples_per_bin - remainder) % samples_per_second < 100);
+            }
+            const uint8_t expected_offset = (Demodulator_t::fine_lead_bins - 1) * samples_per_bin +
+                                            (remainder < samples_per_bin / 2? samples_per_bin + remainder: remainder);
+            assert(F("fine_phase finds the edge within the fine window"),
+                   decoder.edge_offset == expected_offset,
+                   decoder.edge_offset,
+                   expected_offset);
+        }
+    }
+
+    {  // adaptive N
+        Demodulator_t decoder;
+        decoder.setup();
+        decoder.set_has_tuned_clock();
+        decoder.data[0] = decoder.N;
+
+        // 10 ppm
+        const int32_t rate = Demodulator_t::drift_sample / 100000;
+        const uint32_t seconds_to_drift_one_bin = (uint32_t)Demodulator_t::drift_sample / bin_count / rate;
+        decoder.adapt_N(rate);
+        assert(F("measured drift bounds N"),
+               decoder.N <= seconds_to_drift_one_bin && 2*(uint32_t)decoder.N > seconds_to_drift_one_bin,
+               decoder.N,
+               seconds_to_drift_one_bin);
+        assert(F("reducing N scales the bins"),
+               decoder.data[0] == decoder.N,
+               decoder.data[0],
+               decoder.N);
+
+        decoder.adapt_N(1);
+        assert(F("negligible drift allows tuned N"),
+               decoder.N == Demodulator_t::tuned_N,
+               decoder.N,
+               Demodulator_t::tuned_N);
+
+        decoder.adapt_N(rate);
+        decoder.adapt_N(0);
+        assert(F("unknown drift falls back to nominal N"),
+               decoder.N == Demodulator_t::tuned_N,
+               decoder.N,
+               Demodulator_t::tuned_N);
+    }
+
+    {  // bitsliced demodulator
+        typedef DCF77_Bitsliced_Demodulator<controller_t, uint8_t> Bitsliced_t;
+        Bitsliced_t bitsliced;
+        Demodulator_t channel[Bitsliced_t::channel_count];
+        bitsliced.setup();
+        for (uint8_t index = 0; index < Bitsliced_t::channel_count; ++index) {
+            channel[index].setup();
+        }
+        uint8_t sum[Bitsliced_t::channel_count] = {};
+        uint16_t seed = 1;
+        for (uint16_t sample = 0; sample < 4*samples_per_second; ++sample) {
+            uint8_t sampled_data = 0;
+            for (uint8_t index = 0; index < Bitsliced_t::channel_count; ++index) {
+                seed = seed * 75 + 74;
+                const uint8_t bit = ((sample + 97*index) % samples_per_second < 100) ^ (seed % (index + 3) == 0);
+                sampled_data |= bit << index;
+                sum[index] += bit;
+            }
+            // channel 7 holds its bins during the second second
+            bitsliced.hold = (sample / samples_per_second == 1) << 7;
+            if (bitsliced.detector(sampled_data)) {
+                for (uint8_t index = 0; index < Bitsliced_t::channel_count; ++index) {
+                    channel[index].idle_seconds = ((bitsliced.hold >> index) & 1)? Demodulator_t::max_idle_seconds: 0;
+                    channel[index].phase_binning(sum[index] > samples_per_bin / 2);
+                    sum[index] = 0;
+                }
+            }
+        }
+        bool same = true;
+        for (uint8_t index = 0; index < Bitsliced_t::channel_count; ++index) {
+            typename Demodulator_t::data_t bins[bin_count];
+            bitsliced.get_bins(index, bins);
+            same = same && memcmp(bins, channel[index].data, sizeof(bins)) == 0;
+        }
+        assert(F("bitsliced phase bins match the per channel phase bins"),
+               same,
+               Bitsliced_t::sum_planes,
+               Bitsliced_t::bin_planes);
+    }
+
     {  // decode_200ms
         Demodulator_t decoder;
         controller_t::last_tick = (DCF77::tick_t) 0xFF;
+        Monitor_T::tick_decisions = 0;
         decoder.decoded_data = 0;
         for (int16_t bins_to_go = decoder.bins_per_200ms+1, bins_gone = 0; bins_to_go > 0; --bins_to_go, ++bins_gone) {
             decoder.decode_200ms(0, bins_to_go);
@@ -5332,6 +5519,10 @@ void test_Demodulator_internal() {
                controller_t::last_tick == DCF77::sync_mark,
                controller_t::last_tick,
                hires);
+        assert(F("monitor notified once per decoded tick"),
+               Monitor_T::tick_decisions == 1,
+               Monitor_T::tick_decisions,
+               hires);
 
         controller_t::last_tick = (DCF77::tick_t) 0xFF;
         decoder.decoded_data = 0;
@@ -5429,6 +5620,69 @@ void test_Demodulator_internal() {
                hires);
     }
 
+    {  // detect_carrier
+        Demodulator_t decoder;
+        decoder.setup();
+        controller_t::carrier_events = 0;
+
+        for (uint8_t second = 0; second < 3; ++second) {
+            decoder.transitions = 2;
+            decoder.pulse_count = Demodulator_t::pulse_bins;
+            decoder.gap_count = 0;
+            decoder.detect_carrier();
+        }
+        assert(F("clean pulses indicate a carrier"),
+               decoder.carrier_present && controller_t::carrier_events == 1,
+               decoder.contrast,
+               controller_t::carrier_events);
+
+        decoder.transitions = 0;
+        decoder.pulse_count = 0;
+        decoder.gap_count = 0;
+        decoder.detect_carrier();
+        assert(F("sync mark keeps the carrier"),
+               decoder.carrier_present && controller_t::carrier_events == 1,
+               decoder.idle_seconds,
+               controller_t::carrier_events);
+
+        decoder.transitions = 0;
+        decoder.pulse_count = Demodulator_t::pulse_bins;
+        decoder.gap_count = Demodulator_t::gap_bins;
+        decoder.detect_carrier();
+        assert(F("stuck input loses the carrier"),
+               !decoder.carrier_present && controller_t::carrier_events == 2,
+               decoder.idle_seconds,
+               controller_t::carrier_events);
+
+        for (uint16_t bin = 0; bin < bin_count; ++bin) {
+            decoder.data[bin] = bin % 2;
+        }
+        for (uint16_t bin = 0; bin < bin_count; ++bin) {
+            decoder.phase_binning(bin % 2 == 0);
+        }
+        uint16_t altered_bins = 0;
+        for (uint16_t bin = 0; bin < bin_count; ++bin) {
+            altered_bins += decoder.data[bin] != bin % 2;
+        }
+        assert(F("stuck input does not alter the phase bins"),
+               altered_bins == 0,
+               altered_bins,
+               hires);
+
+        decoder.setup();
+        controller_t::carrier_events = 0;
+        for (uint8_t second = 0; second < 60; ++second) {
+            decoder.transitions = 40;
+            decoder.pulse_count = Demodulator_t::pulse_bins / 2;
+            decoder.gap_count = Demodulator_t::gap_bins / 2;
+            decoder.detect_carrier();
+        }
+        assert(F("noise without contrast indicates no carrier"),
+               !decoder.carrier_present && controller_t::carrier_events == 0,
+               decoder.contrast,
+               controller_t::carrier_events);
+    }
+
     {  // stage_with_averages
         if (samples_per_bin > 1) {
             typename Demodulator_t::stage_with_averages stage;
@@ -5488,6 +5742,7 @@ void test_Demodulator() {
 
     test_Demodulator_internal<Configuration_T<false> >();
     test_Demodulator_internal<Configuration_T<true> >();
+    test_Demodulator_internal<Configuration_T<true, true> >();
 }
 
 void test_Binning() {
@@ -5719,6 +5974,38 @@ void test_Minute_Decoder() {
         assert(F("quality 22-20"), lq.lock_max == 22 && lq.noise_max == 20,
                  lq.lock_max, lq.noise_max, lq.lock_max - lq.noise_max);
 
+        // the fast path yields the same bins as full binning
+        Minute_Decoder.setup();
+        for (uint8_t second = 0; second < 60; ++second) {
+            Minute_Decoder.process_tick(second, 0);
+        }
+        DCF77_Minute_Decoder Full_Minute_Decoder = Minute_Decoder;
+        Minute_Decoder.set_fast_path(true);
+        for (uint8_t second = 0; second < 60; ++second) {
+            Minute_Decoder.process_tick(second, 0);
+            Full_Minute_Decoder.process_tick(second, 0);
+        }
+        Minute_Decoder.get_quality(lq);
+        assert(F("fast path quality 12-8"), lq.lock_max == 12 && lq.noise_max == 8,
+                 lq.lock_max, lq.noise_max, lq.lock_max - lq.noise_max);
+        assert(F("fast path keeps minute 0"), Minute_Decoder.get_time_value().val == 0 && Minute_Decoder.fast_path,
+                 Minute_Decoder.get_time_value().val, Minute_Decoder.fast_path);
+        assert(F("fast path bins match full binning"),
+               memcmp(Minute_Decoder.data, Full_Minute_Decoder.data, sizeof(Minute_Decoder.data)) == 0 &&
+               Minute_Decoder.noise_max == Full_Minute_Decoder.noise_max,
+               Minute_Decoder.noise_max, Full_Minute_Decoder.noise_max);
+
+        for (uint8_t second = 0; second < 60; ++second) {
+            Minute_Decoder.process_tick(second, second == 22);
+            Full_Minute_Decoder.process_tick(second, second == 22);
+        }
+        assert(F("disagreement leaves fast path"), !Minute_Decoder.fast_path, Minute_Decoder.fast_path);
+        assert(F("bins match full binning after disagreement"),
+               memcmp(Minute_Decoder.data, Full_Minute_Decoder.data, sizeof(Minute_Decoder.data)) == 0,
+               Minute_Decoder.signal_max, Full_Minute_Decoder.signal_max);
+        assert(F("full binning keeps minute 0"), Minute_Decoder.get_time_value().val == 0,
+                 Minute_Decoder.get_time_value().val);
+
         Minute_Decoder.setup();
         for (int8_t minute = 0; minute < 60; ++minute) {
             for (uint8_t second = 0; second < 60; ++second) {
@@ -5868,6 +6155,49 @@ void test_Minute_Decoder() {
     }
 }
 
+template <typename decoder_t>
+void feed_minute(decoder_t &decoder, const uint8_t minute) {
+    const uint8_t bits = minute | Internal::Arithmetic_Tools::parity(minute) << 7;
+    for (uint8_t second = 0; second < 60; ++second) {
+        decoder.process_tick(second, second >= 21 && second <= 28? (bits >> (second - 21)) & 1: 0);
+    }
+}
+
+void test_Sequence_Decoder() {
+    using namespace Internal;
+
+    Binning::Sequence_Decoder<60, 21, 7, 4> decoder;
+    decoder.setup();
+    assert(F("sequence defaults to -1"), decoder.get_time_value().val == 0xff, decoder.get_time_value().val);
+
+    feed_minute(decoder, 0x17);
+    assert(F("sequence locks to minute 17"), decoder.get_time_value().val == 0x17, decoder.get_time_value().val);
+    decoder.advance_tick();
+    feed_minute(decoder, 0x18);
+    decoder.advance_tick();
+    feed_minute(decoder, 0x19);
+    assert(F("sequence follows minutes"), decoder.get_time_value().val == 0x19 && decoder.frame_count == 3,
+           decoder.get_time_value().val, decoder.frame_count);
+
+    // after window frames of a different sequence the old frames are gone
+    for (uint8_t minute = 0x40; minute < 0x44; ++minute) {
+        decoder.advance_tick();
+        feed_minute(decoder, minute);
+    }
+    assert(F("sequence window forgets"), decoder.get_time_value().val == 0x43 && decoder.frame_count == 4,
+           decoder.get_time_value().val, decoder.frame_count);
+    assert(F("sequence scores window only"), decoder.score[decoder.signal_max_index] == 4*8,
+           decoder.score[decoder.signal_max_index]);
+
+    BCD::bcd_t minute;
+    minute.val = 0x05;
+    decoder.align(minute);
+    decoder.advance_tick();
+    feed_minute(decoder, 0x06);
+    assert(F("sequence follows align"), decoder.get_time_value().val == 0x06 && decoder.score[decoder.signal_max_index] == 4*8,
+           decoder.get_time_value().val, decoder.score[decoder.signal_max_index]);
+}
+
 void test_Hour_Decoder() {
     using namespace Internal;
     {   // test all 0
@@ -5903,6 +6233,40 @@ void test_Hour_Decoder() {
         assert(F("advances to hour 0"), Hour_Decoder.get_time_value().val == 0,
                  Hour_Decoder.get_time_value().val);
 
+        BCD::bcd_t hour;
+        hour.val = 0x17;
+        Hour_Decoder.align(hour);
+        assert(F("aligns to hour 17"), Hour_Decoder.get_time_value().val == 0x17,
+                 Hour_Decoder.get_time_value().val);
+        Hour_Decoder.advance_tick();
+        assert(F("advances to hour 18"), Hour_Decoder.get_time_value().val == 0x18,
+                 Hour_Decoder.get_time_value().val);
+        hour.val = 0x24;
+        Hour_Decoder.align(hour);
+        assert(F("ignores invalid hour"), Hour_Decoder.get_time_value().val == 0x18,
+                 Hour_Decoder.get_time_value().val);
+
+        hour.val = 0x18;
+        assert(F("bin of current hour"), Hour_Decoder.get_bin_index(hour) == Hour_Decoder.signal_max_index,
+                 Hour_Decoder.get_bin_index(hour), Hour_Decoder.signal_max_index);
+        hour.val = 0x05;
+        Hour_Decoder.seed(hour, 20);
+        assert(F("seeds hour 5"), Hour_Decoder.get_time_value().val == 0x05,
+                 Hour_Decoder.get_time_value().val);
+        assert(F("value of strongest bin"), Hour_Decoder.get_bin_value(Hour_Decoder.signal_max_index).val == 0x05,
+                 Hour_Decoder.get_bin_value(Hour_Decoder.signal_max_index).val);
+        hour.val = 0x18;
+        assert(F("runner up is hour 18"), Hour_Decoder.get_runner_up_index() == Hour_Decoder.get_bin_index(hour),
+                 Hour_Decoder.get_runner_up_index(), Hour_Decoder.get_bin_index(hour));
+
+        Hour_Decoder.signal_max = 63;
+        assert(F("fixed gain of sparse bins"), Hour_Decoder.get_gain() == 1, Hour_Decoder.get_gain());
+        Hour_Decoder.set_annealed(true);
+        assert(F("annealed gain of sparse bins"), Hour_Decoder.get_gain() == 2, Hour_Decoder.get_gain());
+        Hour_Decoder.signal_max = 64;
+        assert(F("gain of filled bins"), Hour_Decoder.get_gain() == 1, Hour_Decoder.get_gain());
+        Hour_Decoder.set_annealed(false);
+
 
         Hour_Decoder.setup();
         for (uint8_t pass = 0; pass < 10; ++pass) {
@@ -6826,6 +7190,1259 @@ void test_Weekday_Decoder() {
     }
 }
 
+namespace telemetry_sink {
+    uint8_t buffer[32];
+    uint8_t length = 0;
+
+    void put(const uint8_t data) {
+        if (length < sizeof(buffer)) {
+            buffer[length++] = data;
+        }
+    }
+}
+
+// reassembles the chunked phase bins frames of the demodulator
+namespace phase_bins_sink {
+    Internal::Telemetry::Decoder<128> decoder;
+    uint16_t bins[1000];
+    uint16_t bin_count;
+    uint16_t received_bins;
+    uint8_t frames;
+    bool ok;
+
+    void setup() {
+        decoder.setup();
+        received_bins = 0;
+        frames = 0;
+        ok = true;
+    }
+
+    void put(const uint8_t data) {
+        using namespace Internal;
+        if (decoder.receive(data)) {
+            ++frames;
+            Telemetry::Reader reader;
+            reader.setup(decoder.payload, decoder.payload_length);
+            bin_count = reader.get_16();
+            const uint16_t first_bin = reader.get_16();
+            const uint8_t chunk = reader.get();
+            reader.get_16();  // tick
+            reader.get_16();  // signal_max_index
+            reader.get_32();  // signal_max
+            reader.get_32();  // noise_max
+            reader.get_16();  // N
+            ok = ok && decoder.frame_type == Telemetry::phase_bins_frame && first_bin == received_bins;
+            int32_t previous = 0;
+            for (uint8_t bin = 0; bin < chunk && received_bins < sizeof(bins)/sizeof(bins[0]); ++bin) {
+                previous += Telemetry::unzigzag(reader.get_varint());
+                bins[received_bins++] = previous;
+            }
+            ok = ok && reader.ok && reader.position == reader.length;
+        }
+    }
+}
+
+void test_Frame_Decoder() {
+    using namespace Internal;
+
+    DCF77_Encoder encoder;
+    encoder.year.val = 0x07;
+    encoder.month.val = 0x12;
+    encoder.day.val = 0x31;
+    encoder.hour.val = 0x23;
+    encoder.minute.val = 0x30;
+    encoder.second = 0;
+    encoder.autoset_weekday();
+    encoder.autoset_control_bits();
+    encoder.abnormal_transmitter_operation = false;
+    encoder.undefined_abnormal_transmitter_operation_output = false;
+    encoder.undefined_timezone_change_scheduled_output = false;
+    encoder.undefined_uses_summertime_output = false;
+    encoder.undefined_minute_output = false;
+
+    DCF77_Naive_Bitstream_Decoder::Frame_Decoder frame_decoder;
+    frame_decoder.setup();
+
+    // the first sync mark only starts the frame
+    uint8_t frames = 0;
+    for (uint8_t tick = 0; tick < 60; ++tick) {
+        frames += frame_decoder.process_tick(encoder.get_current_signal());
+        encoder.advance_second();
+    }
+    assert(F("no frame before first sync mark"), frames == 0, frames);
+
+    for (uint8_t tick = 0; tick < 60; ++tick) {
+        frames += frame_decoder.process_tick(encoder.get_current_signal());
+        encoder.advance_second();
+    }
+    assert(F("frame decoded"), frames == 1, frames);
+    assert(F("frame minute"), frame_decoder.frame.minute.val == 0x31, frame_decoder.frame.minute.val);
+    assert(F("frame hour"), frame_decoder.frame.hour.val == 0x23, frame_decoder.frame.hour.val);
+    assert(F("frame day"), frame_decoder.frame.day.val == 0x31, frame_decoder.frame.day.val);
+    assert(F("frame weekday"), frame_decoder.frame.weekday.val == 0x01, frame_decoder.frame.weekday.val);
+
+    // a flipped minute bit breaks the minute parity
+    frames = 0;
+    for (uint8_t tick = 0; tick < 60; ++tick) {
+        const uint8_t tick_data = encoder.get_current_signal();
+        frames += frame_decoder.process_tick(tick == 21? (uint8_t)(tick_data == DCF77::short_tick? DCF77::long_tick: DCF77::short_tick): tick_data);
+        encoder.advance_second();
+    }
+    assert(F("parity error rejects frame"), frames == 0, frames);
+
+    // an undefined tick rejects the frame as well
+    for (uint8_t tick = 0; tick < 60; ++tick) {
+        const uint8_t tick_data = encoder.get_current_signal();
+        frames += frame_decoder.process_tick(tick == 40? (uint8_t)DCF77::undefined: tick_data);
+        encoder.advance_second();
+    }
+    assert(F("undefined tick rejects frame"), frames == 0, frames);
+
+    for (uint8_t tick = 0; tick < 60; ++tick) {
+        frames += frame_decoder.process_tick(encoder.get_current_signal());
+        encoder.advance_second();
+    }
+    assert(F("frame decoded after errors"), frames == 1, frames);
+    assert(F("frame minute after errors"), frame_decoder.frame.minute.val == 0x34, frame_decoder.frame.minute.val);
+}
+
+void test_Tick_History() {
+    using namespace Internal;
+
+    Tick_History<1> history;
+    history.setup();
+    assert(F("empty history"), history.count == 0, history.count);
+
+    const DCF77::tick_t ticks[4] = { DCF77::short_tick, DCF77::long_tick, DCF77::undefined, DCF77::sync_mark };
+    for (uint8_t tick = 0; tick < 5; ++tick) {
+        history.push(ticks[tick % 4]);
+    }
+    assert(F("count"), history.count == 5, history.count);
+    assert(F("most recent tick"), history.get(0) == DCF77::short_tick, history.get(0));
+    assert(F("age 1"), history.get(1) == DCF77::sync_mark, history.get(1));
+    assert(F("age 2"), history.get(2) == DCF77::undefined, history.get(2));
+    assert(F("oldest tick"), history.get(4) == DCF77::short_tick, history.get(4));
+
+    // wrap around, the oldest ticks are overwritten
+    for (uint8_t tick = 5; tick < 62; ++tick) {
+        history.push(ticks[tick % 4]);
+    }
+    assert(F("count saturates"), history.count == 60, history.count);
+    assert(F("most recent tick after wrap"), history.get(0) == DCF77::long_tick, history.get(0));
+    assert(F("oldest tick after wrap"), history.get(59) == DCF77::undefined, history.get(59));
+}
+
+template <typename tracker_t>
+void test_deviation_tracker_process_ticks() {
+    tracker_t per_tick;
+    tracker_t bulk;
+    per_tick.start(0);
+    bulk.start(0);
+    // start close to the wrap around
+    per_tick.elapsed_ticks_mod_60000 = 59000;
+    bulk.elapsed_ticks_mod_60000 = 59000;
+
+    bool same = true;
+    uint16_t seed = 1;
+    for (uint16_t step = 0; step < 2000; ++step) {
+        seed = seed * 75 + 74;
+        const uint8_t ticks = seed % 256;
+        for (uint8_t tick = 0; tick < ticks; ++tick) {
+            per_tick.process_tick();
+        }
+        bulk.process_ticks(ticks);
+        same = same &&
+               per_tick.elapsed_ticks_mod_60000 == bulk.elapsed_ticks_mod_60000 &&
+               per_tick.elapsed_minutes == bulk.elapsed_minutes;
+    }
+    assert(F("process_ticks matches process_tick"), same,
+           per_tick.elapsed_minutes, bulk.elapsed_minutes);
+}
+
+void test_Deviation_Tracker() {
+    using namespace Internal;
+
+    test_deviation_tracker_process_ticks<DCF77_Frequency_Control::generic_deviation_tracker_t>();
+    test_deviation_tracker_process_ticks<DCF77_Frequency_Control::averaging_deviation_tracker_t>();
+}
+
+// noisy DCF77 signal, one sample per millisecond
+struct sample_generator {
+    Internal::DCF77_Encoder encoder;
+    uint16_t ms;
+    uint16_t pulse_ms;
+    uint16_t seed;
+    // without signal the receiver output is stuck at 0
+    bool signal_present;
+
+    void setup() {
+        encoder.year.val = 0x17;
+        encoder.month.val = 0x05;
+        encoder.day.val = 0x21;
+        encoder.hour.val = 0x12;
+        encoder.minute.val = 0x57;
+        encoder.second = 0;
+        encoder.autoset_weekday();
+        encoder.autoset_control_bits();
+        encoder.abnormal_transmitter_operation = false;
+        encoder.undefined_abnormal_transmitter_operation_output = false;
+        encoder.undefined_timezone_change_scheduled_output = false;
+        encoder.undefined_uses_summertime_output = false;
+        encoder.undefined_minute_output = false;
+        ms = 0;
+        seed = 1;
+        signal_present = true;
+        start_second();
+    }
+
+    void start_second() {
+        const Internal::DCF77::tick_t tick_data = encoder.get_current_signal();
+        // the undefined weather bits are sent as short ticks
+        pulse_ms = tick_data == Internal::DCF77::long_tick? 200:
+                   tick_data == Internal::DCF77::sync_mark?   0: 100;
+    }
+
+    uint8_t next() {
+        seed = seed * 75 + 74;
+        const uint8_t sample = signal_present && ((ms < pulse_ms) ^ (seed % 16 == 0));
+        if (++ms == 1000) {
+            ms = 0;
+            encoder.advance_second();
+            start_second();
+        }
+        return sample;
+    }
+};
+
+template <typename Clock_Controller>
+void run_clock(sample_generator &generator, const uint32_t ms) {
+    for (uint32_t sample = 0; sample < ms; ++sample) {
+        Clock_Controller::process_1_kHz_tick_data(generator.next());
+    }
+}
+
+void test_Phase_Events() {
+    using namespace Internal;
+    typedef DCF77_Clock_Controller<Configuration, DCF77_No_Frequency_Control> Clock_Controller_t;
+    sample_generator generator;
+
+    Clock_Controller_t::setup();
+    generator.setup();
+    run_clock<Clock_Controller_t>(generator, 200000);
+    assert(F("phase events: synced"), Clock_Controller_t::get_clock_state() == Clock::synced,
+           Clock_Controller_t::get_clock_state());
+
+    {
+        // a short loss freezes the decoders
+        const uint8_t minute_quality = Clock_Controller_t::Minute_Decoder.get_quality_factor();
+        generator.signal_present = false;
+        run_clock<Clock_Controller_t>(generator, 5000);
+        assert(F("short loss unlocks and freezes"),
+               Clock_Controller_t::get_clock_state() == Clock::unlocked &&
+               Clock_Controller_t::decoders_frozen,
+               Clock_Controller_t::get_clock_state(), Clock_Controller_t::decoders_frozen);
+
+        // the diagnostics are published during the outage as well
+        Clock_Controller_t::clock_diagnostics_t diagnostics;
+        Clock_Controller_t::read_diagnostics(diagnostics);
+        assert(F("short loss diagnostics"), diagnostics.quality.clock_state == Clock::unlocked,
+               diagnostics.quality.clock_state);
+
+        // once the phase returns the decoders resume where the local clock is
+        generator.signal_present = true;
+        run_clock<Clock_Controller_t>(generator, 5000 + (1500 - generator.ms) % 1000);
+        // the encoder of the generator is one minute ahead as it sends the next minute
+        DCF77_Encoder local_time = Clock_Controller_t::Local_Clock.local_clock_time;
+        for (uint8_t second = 0; second < 60; ++second) {
+            local_time.advance_second();
+        }
+        assert(F("short loss resumes"),
+               Clock_Controller_t::get_clock_state() >= Clock::locked &&
+               !Clock_Controller_t::decoders_frozen &&
+               local_time.minute.val == generator.encoder.minute.val &&
+               local_time.second == generator.encoder.second,
+               Clock_Controller_t::get_clock_state(), local_time.second, generator.encoder.second);
+
+        // the frozen bins were rotated by the lost seconds
+        run_clock<Clock_Controller_t>(generator, (61 - generator.encoder.second) * 1000uL);
+        assert(F("short loss keeps the minute"),
+               Clock_Controller_t::Minute_Decoder.get_time_value().val == generator.encoder.minute.val &&
+               Clock_Controller_t::Minute_Decoder.get_quality_factor() >= minute_quality,
+               Clock_Controller_t::Minute_Decoder.get_time_value().val, generator.encoder.minute.val,
+               Clock_Controller_t::Minute_Decoder.get_quality_factor(), minute_quality);
+    }
+
+    {
+        // the decoders are reset once the local clock is free running
+        Clock_Controller_t::Local_Clock.max_unlocked_seconds = 10;
+        generator.signal_present = false;
+        run_clock<Clock_Controller_t>(generator, 15000);
+        assert(F("long loss resets"),
+               Clock_Controller_t::get_clock_state() == Clock::free &&
+               !Clock_Controller_t::decoders_frozen &&
+               Clock_Controller_t::Second_Decoder.get_quality_factor() == 0 &&
+               Clock_Controller_t::Minute_Decoder.get_quality_factor() == 0,
+               Clock_Controller_t::get_clock_state(), Clock_Controller_t::decoders_frozen,
+               Clock_Controller_t::Minute_Decoder.get_quality_factor());
+    }
+
+    {
+        // the decoders are reset if the phase returns 500 ms off
+        Clock_Controller_t::setup();
+        generator.setup();
+        run_clock<Clock_Controller_t>(generator, 200000);
+        for (uint16_t ms = 0; ms < 500; ++ms) {
+            generator.next();
+        }
+
+        bool frozen = false;
+        uint32_t ms = 0;
+        while (ms < 200000 && !(frozen && !Clock_Controller_t::decoders_frozen)) {
+            frozen = frozen || Clock_Controller_t::decoders_frozen;
+            run_clock<Clock_Controller_t>(generator, 1);
+            ++ms;
+        }
+        assert(F("phase offset resets"),
+               frozen && !Clock_Controller_t::decoders_frozen &&
+               Clock_Controller_t::get_clock_state() == Clock::unlocked &&
+               Clock_Controller_t::Second_Decoder.get_quality_factor() == 0 &&
+               Clock_Controller_t::Minute_Decoder.get_quality_factor() == 0,
+               frozen, Clock_Controller_t::get_clock_state(), Clock_Controller_t::Local_Clock.tick);
+    }
+}
+
+void test_Diagnostics() {
+    using namespace Internal;
+    typedef DCF77_Clock_Controller<Configuration, DCF77_No_Frequency_Control> Clock_Controller_t;
+    sample_generator generator;
+
+    Clock_Controller_t::setup();
+    generator.setup();
+    run_clock<Clock_Controller_t>(generator, 200000);
+    assert(F("diagnostics: synced"), Clock_Controller_t::get_clock_state() == Clock::synced,
+           Clock_Controller_t::get_clock_state());
+
+    {
+        // setup publishes the diagnostics of the reset clock
+        Clock_Controller_t::setup();
+        Clock_Controller_t::clock_diagnostics_t diagnostics;
+        Clock_Controller_t::read_diagnostics(diagnostics);
+        assert(F("diagnostics: reset by setup"),
+               diagnostics.quality.clock_state == Clock::useless &&
+               diagnostics.quality_factor.minute == 0 &&
+               diagnostics.overall_quality_factor == 0,
+               diagnostics.quality.clock_state, diagnostics.quality_factor.minute,
+               diagnostics.overall_quality_factor);
+
+        generator.setup();
+        run_clock<Clock_Controller_t>(generator, 200000);
+    }
+
+    // the diagnostics are published once per second
+    uint8_t generation = Clock_Controller_t::diagnostics_generation;
+    while (generation == Clock_Controller_t::diagnostics_generation) {
+        run_clock<Clock_Controller_t>(generator, 1);
+    }
+    generation = Clock_Controller_t::diagnostics_generation;
+    run_clock<Clock_Controller_t>(generator, 10000);
+    assert(F("diagnostics: published each second"),
+           (uint8_t)(Clock_Controller_t::diagnostics_generation - generation) == 10,
+           generation, Clock_Controller_t::diagnostics_generation);
+
+    // right after publishing the diagnostics agree with the stages
+    generation = Clock_Controller_t::diagnostics_generation;
+    while (generation == Clock_Controller_t::diagnostics_generation) {
+        run_clock<Clock_Controller_t>(generator, 1);
+    }
+    Clock_Controller_t::clock_diagnostics_t diagnostics;
+    Clock_Controller_t::read_diagnostics(diagnostics);
+    Clock_Controller_t::clock_quality_factor_t quality_factor;
+    Clock_Controller_t::get_quality_factor(quality_factor);
+    Clock_Controller_t::clock_quality_t quality;
+    Clock_Controller_t::get_quality(quality);
+    assert(F("diagnostics: consistent"),
+           !memcmp(&diagnostics.quality_factor, &quality_factor, sizeof(quality_factor)) &&
+           diagnostics.overall_quality_factor == Clock_Controller_t::get_overall_quality_factor() &&
+           diagnostics.quality.clock_state == Clock::synced &&
+           diagnostics.quality.prediction_match == quality.prediction_match &&
+           diagnostics.quality.minute.lock_max == quality.minute.lock_max &&
+           diagnostics.quality.minute.noise_max == quality.minute.noise_max,
+           diagnostics.quality_factor.minute, quality_factor.minute,
+           diagnostics.overall_quality_factor, Clock_Controller_t::get_overall_quality_factor());
+
+    // publishing writes the other buffer, the published one stays intact for readers
+    generation = Clock_Controller_t::diagnostics_generation;
+    const Clock_Controller_t::clock_diagnostics_t published = Clock_Controller_t::diagnostics[generation & 1];
+    Clock_Controller_t::publish_diagnostics();
+    assert(F("diagnostics: double buffered"),
+           Clock_Controller_t::diagnostics_generation == (uint8_t)(generation + 1) &&
+           !memcmp(&Clock_Controller_t::diagnostics[generation & 1], &published, sizeof(published)),
+           generation, Clock_Controller_t::diagnostics_generation);
+
+    Clock_Controller_t::setup();
+}
+
+void test_Statistics() {
+    using namespace Internal;
+    typedef DCF77_Clock_Controller<Configuration, DCF77_No_Frequency_Control> Clock_Controller_t;
+    sample_generator generator;
+    Clock_Controller_t::clock_statistics_t statistics;
+
+    // setup() does not reset the second toggle of the local clock,
+    // thus the bulk run below starts from a copy
+    uint8_t local_clock[sizeof(Clock_Controller_t::Local_Clock)];
+    memcpy(local_clock, (const void *)&Clock_Controller_t::Local_Clock, sizeof(local_clock));
+
+    Clock_Controller_t::setup();
+    generator.setup();
+    run_clock<Clock_Controller_t>(generator, 200000);
+    Clock_Controller_t::read_statistics(statistics);
+    {
+        uint32_t ticks = 0;
+        uint32_t seconds = 0;
+        for (uint8_t tick = 0; tick < 4; ++tick) {
+            ticks += statistics.ticks[tick];
+        }
+        for (uint8_t state = Clock::useless; state <= Clock::synced; ++state) {
+            seconds += statistics.seconds_in_state[state];
+        }
+        assert(F("statistics: one tick and one state per second"),
+               statistics.uptime_seconds == 200 && ticks == 200 && seconds == 200 &&
+               statistics.ticks[DCF77::sync_mark] == 3 && statistics.ticks[DCF77::undefined] == 0 &&
+               statistics.seconds_in_state[Clock::synced] > 0,
+               statistics.uptime_seconds, ticks, seconds, statistics.ticks[DCF77::sync_mark],
+               statistics.seconds_in_state[Clock::synced]);
+        assert(F("statistics: no events with a good signal"),
+               statistics.phase_lost_events == 0 && statistics.sync_lost_events == 0 &&
+               statistics.decoder_resets == 0 && statistics.carrier_lost_events == 0 &&
+               statistics.leap_seconds == 0,
+               statistics.phase_lost_events, statistics.sync_lost_events,
+               statistics.decoder_resets, statistics.carrier_lost_events);
+    }
+
+    // the stages lock in the order of the pipeline
+    const Clock_Controller_t::lock_timeline_t first_lock = statistics.first_lock;
+    assert(F("statistics: lock timeline"),
+           first_lock.phase > 0 && first_lock.phase <= first_lock.second &&
+           first_lock.second < first_lock.minute && first_lock.minute <= first_lock.hour &&
+           first_lock.hour <= first_lock.day && first_lock.day <= first_lock.month &&
+           first_lock.month <= first_lock.year && first_lock.weekday > 0 &&
+           first_lock.year <= statistics.uptime_seconds,
+           first_lock.phase, first_lock.second, first_lock.minute, first_lock.year);
+
+    // a short loss of the signal
+    generator.signal_present = false;
+    run_clock<Clock_Controller_t>(generator, 5000);
+    generator.signal_present = true;
+    run_clock<Clock_Controller_t>(generator, 60000);
+    Clock_Controller_t::read_statistics(statistics);
+    assert(F("statistics: phase lost"),
+           statistics.phase_lost_events == 1 && statistics.carrier_lost_events == 1 &&
+           statistics.seconds_in_state[Clock::unlocked] > 0 &&
+           statistics.uptime_seconds == 265,
+           statistics.phase_lost_events, statistics.carrier_lost_events, statistics.uptime_seconds);
+    assert(F("statistics: the timeline keeps the first lock"),
+           !memcmp((const void *)&statistics.first_lock, &first_lock, sizeof(first_lock)),
+           statistics.first_lock.minute, first_lock.minute);
+
+    {
+        // sync lost with empty decoders resets all of them
+        Clock_Controller_t::setup();
+        Clock_Controller_t::read_statistics(statistics);
+        assert(F("statistics: reset by setup"),
+               statistics.uptime_seconds == 0 && statistics.phase_lost_events == 0 &&
+               statistics.first_lock.phase == 0,
+               statistics.uptime_seconds, statistics.phase_lost_events);
+
+        Clock_Controller_t::sync_lost_event_handler();
+        Clock_Controller_t::read_statistics(statistics);
+        assert(F("statistics: decoder resets"),
+               statistics.sync_lost_events == 1 && statistics.decoder_resets == 6,
+               statistics.sync_lost_events, statistics.decoder_resets);
+    }
+
+    {
+        // the bulk path of process_samples counts the same
+        memcpy((void *)&Clock_Controller_t::Local_Clock, local_clock, sizeof(local_clock));
+        Clock_Controller_t::setup();
+        generator.setup();
+        run_clock<Clock_Controller_t>(generator, 100000);
+        Clock_Controller_t::clock_statistics_t per_sample;
+        Clock_Controller_t::read_statistics(per_sample);
+
+        memcpy((void *)&Clock_Controller_t::Local_Clock, local_clock, sizeof(local_clock));
+        Clock_Controller_t::setup();
+        generator.setup();
+        for (uint32_t sample = 0; sample < 100000; sample += 32) {
+            uint32_t packed = 0;
+            for (uint8_t index = 0; index < 32; ++index) {
+                packed |= (uint32_t)generator.next() << index;
+            }
+            Clock_Controller_t::process_samples(&packed, 32);
+        }
+        Clock_Controller_t::read_statistics(statistics);
+        assert(F("statistics: process_samples"),
+               !memcmp(&statistics, &per_sample, sizeof(statistics)),
+               statistics.uptime_seconds, per_sample.uptime_seconds);
+    }
+
+    Clock_Controller_t::setup();
+}
+
+void test_Time_Hint() {
+    using namespace Internal;
+    typedef DCF77_Clock_Controller<Configuration, DCF77_No_Frequency_Control> Clock_Controller_t;
+    sample_generator generator;
+
+    // the generator sends the next minute, thus the current time is 12:56:00
+    generator.setup();
+    DCF77_Encoder hint = generator.encoder;
+    hint.minute.val = 0x56;
+
+    {
+        // the uncertainty decides which decoders may use the hint
+        Clock_Controller_t::setup();
+        Clock_Controller_t::set_time_hint(hint, 10);
+        assert(F("time hint: precise"),
+               Clock_Controller_t::hint_pending == 0x7f &&
+               Clock_Controller_t::hint_time.minute.val == 0x57 &&
+               Clock_Controller_t::hint_minutes == Configuration::time_hint_minutes,
+               Clock_Controller_t::hint_pending, Clock_Controller_t::hint_time.minute.val);
+
+        Clock_Controller_t::set_time_hint(hint, 10*60);
+        assert(F("time hint: minutes off"), Clock_Controller_t::hint_pending == 0x7e,
+               Clock_Controller_t::hint_pending);
+        Clock_Controller_t::set_time_hint(hint, 6*60*60);
+        assert(F("time hint: hours off"), Clock_Controller_t::hint_pending == 0x7c,
+               Clock_Controller_t::hint_pending);
+        Clock_Controller_t::set_time_hint(hint, 24*60*60);
+        assert(F("time hint: useless"), Clock_Controller_t::hint_pending == 0,
+               Clock_Controller_t::hint_pending);
+    }
+
+    {
+        // only a decoder that decodes the hinted value on its own gets the weight
+        Clock_Controller_t::setup();
+        BCD::bcd_t value;
+        value.val = 0x30;
+        Clock_Controller_t::Minute_Decoder.seed(value, 10);
+        const uint8_t signal_max = Clock_Controller_t::Minute_Decoder.signal_max;
+        Clock_Controller_t::hint_pending = Clock_Controller_t::hint_minute;
+
+        value.val = 0x31;
+        Clock_Controller_t::process_hint(Clock_Controller_t::Minute_Decoder, Clock_Controller_t::hint_minute, value);
+        assert(F("time hint: disagreeing decoder ignores the hint"),
+               Clock_Controller_t::Minute_Decoder.signal_max == signal_max &&
+               Clock_Controller_t::hint_pending == Clock_Controller_t::hint_minute,
+               Clock_Controller_t::Minute_Decoder.signal_max, Clock_Controller_t::hint_pending);
+
+        value.val = 0x30;
+        Clock_Controller_t::process_hint(Clock_Controller_t::Minute_Decoder, Clock_Controller_t::hint_minute, value);
+        assert(F("time hint: agreeing decoder is seeded once"),
+               Clock_Controller_t::Minute_Decoder.signal_max == signal_max + Configuration::time_hint_weight &&
+               Clock_Controller_t::Minute_Decoder.get_time_value().val == 0x30 &&
+               Clock_Controller_t::hint_pending == 0,
+               Clock_Controller_t::Minute_Decoder.signal_max, Clock_Controller_t::hint_pending);
+    }
+
+    // reference without hint
+    Clock_Controller_t::setup();
+    generator.setup();
+    run_clock<Clock_Controller_t>(generator, 200000);
+    const uint8_t minute_quality = Clock_Controller_t::Minute_Decoder.get_quality_factor();
+
+    {
+        // a correct hint is used up by all decoders and adds to their evidence
+        Clock_Controller_t::setup();
+        generator.setup();
+        Clock_Controller_t::set_time_hint(hint, 5);
+        run_clock<Clock_Controller_t>(generator, 200000);
+        assert(F("time hint: correct hint"),
+               Clock_Controller_t::get_clock_state() == Clock::synced &&
+               Clock_Controller_t::hint_pending == 0 &&
+               Clock_Controller_t::Minute_Decoder.get_quality_factor() > minute_quality,
+               Clock_Controller_t::get_clock_state(), Clock_Controller_t::hint_pending,
+               Clock_Controller_t::Minute_Decoder.get_quality_factor(), minute_quality);
+    }
+
+    {
+        // a wrong hint is ignored by the decoders that disagree
+        Clock_Controller_t::setup();
+        generator.setup();
+        DCF77_Encoder wrong_hint = hint;
+        wrong_hint.hour.val = 0x14;
+        Clock_Controller_t::set_time_hint(wrong_hint, 5);
+        run_clock<Clock_Controller_t>(generator, 200000);
+        assert(F("time hint: wrong hour"),
+               Clock_Controller_t::get_clock_state() == Clock::synced &&
+               Clock_Controller_t::hint_pending == Clock_Controller_t::hint_hour &&
+               Clock_Controller_t::Hour_Decoder.get_time_value().val == generator.encoder.hour.val,
+               Clock_Controller_t::get_clock_state(), Clock_Controller_t::hint_pending,
+               Clock_Controller_t::Hour_Decoder.get_time_value().val);
+
+        // and expires eventually
+        Clock_Controller_t::hint_minutes = 1;
+        run_clock<Clock_Controller_t>(generator, 60000);
+        assert(F("time hint: expired"), Clock_Controller_t::hint_pending == 0,
+               Clock_Controller_t::hint_pending);
+    }
+
+    Clock_Controller_t::setup();
+}
+
+void test_Rebinning() {
+    using namespace Internal;
+    typedef DCF77_Clock_Controller<Configuration, DCF77_No_Frequency_Control> Clock_Controller_t;
+    sample_generator generator;
+    const uint16_t ticks = 180;
+
+    // bin three minutes directly
+    Clock_Controller_t::setup();
+    generator.setup();
+    DCF77_Encoder encoder = generator.encoder;
+    for (uint16_t tick = 0; tick < ticks; ++tick) {
+        DCF77_Encoder now;
+        now.second = encoder.second;
+        Clock_Controller_t::bin_tick(now, encoder.get_current_signal());
+        encoder.advance_second();
+    }
+    const BCD::bcd_t minute = Clock_Controller_t::Minute_Decoder.get_time_value();
+    const Clock_Controller_t::minute_decoder_t minute_decoder = Clock_Controller_t::Minute_Decoder;
+    const Clock_Controller_t::hour_decoder_t   hour_decoder   = Clock_Controller_t::Hour_Decoder;
+    const DCF77_Day_Decoder                    day_decoder    = Clock_Controller_t::Day_Decoder;
+
+    {
+        // the replay of the history bins the same
+        Clock_Controller_t::setup();
+        encoder = generator.encoder;
+        for (uint16_t tick = 0; tick < ticks; ++tick) {
+            Clock_Controller_t::History.push(encoder.get_current_signal());
+            encoder.advance_second();
+        }
+        Clock_Controller_t::replay_pending = Clock_Controller_t::History.count;
+        Clock_Controller_t::replay_history(59);
+        assert(F("rebinning: replay is bounded per tick"),
+               Clock_Controller_t::replay_pending == ticks - Clock_Controller_t::replay_ticks_per_tick &&
+               Clock_Controller_t::get_overall_quality_factor() == 0,
+               Clock_Controller_t::replay_pending);
+        while (Clock_Controller_t::replay_pending > 0) {
+            Clock_Controller_t::replay_history(59);
+        }
+        assert(F("rebinning: replay matches direct binning"),
+               minute.val == 0x59 &&
+               !memcmp(&Clock_Controller_t::Minute_Decoder, &minute_decoder, sizeof(minute_decoder)) &&
+               !memcmp(&Clock_Controller_t::Hour_Decoder,   &hour_decoder,   sizeof(hour_decoder)) &&
+               !memcmp(&Clock_Controller_t::Day_Decoder,    &day_decoder,    sizeof(day_decoder)),
+               minute.val, Clock_Controller_t::Minute_Decoder.get_time_value().val);
+    }
+
+    {
+        // a shift of the minute alignment resets the decoders and replays the history
+        Clock_Controller_t::Second_Decoder.seed(59, Configuration::frame_weight);
+        const uint8_t second = Clock_Controller_t::Second_Decoder.get_time_value();
+
+        Clock_Controller_t::rebin_on_shift(second);
+        assert(F("rebinning: no shift"),
+               Clock_Controller_t::replay_pending == 0 &&
+               Clock_Controller_t::Minute_Decoder.get_time_value().val == minute.val &&
+               Clock_Controller_t::Minute_Decoder.get_quality_factor() > 0,
+               Clock_Controller_t::replay_pending, second);
+
+        Clock_Controller_t::Local_Clock.clock_state = Clock::locked;
+        Clock_Controller_t::rebin_on_shift((second + 1) % 60);
+        assert(F("rebinning: not while locked"),
+               Clock_Controller_t::replay_pending == 0 &&
+               Clock_Controller_t::Minute_Decoder.get_time_value().val == minute.val,
+               Clock_Controller_t::replay_pending);
+        Clock_Controller_t::Local_Clock.clock_state = Clock::useless;
+
+        Clock_Controller_t::rebin_on_shift((second + 1) % 60);
+        assert(F("rebinning: shift"),
+               Clock_Controller_t::replay_pending == ticks &&
+               Clock_Controller_t::Minute_Decoder.get_quality_factor() == 0 &&
+               Clock_Controller_t::Hour_Decoder.get_quality_factor() == 0,
+               Clock_Controller_t::replay_pending, Clock_Controller_t::Minute_Decoder.get_quality_factor());
+
+        Clock_Controller_t::History.setup();
+        Clock_Controller_t::replay_pending = 0;
+        Clock_Controller_t::rebin_on_shift((second + 1) % 60);
+        assert(F("rebinning: nothing to replay"), Clock_Controller_t::replay_pending == 0,
+               Clock_Controller_t::replay_pending);
+    }
+
+    Clock_Controller_t::setup();
+}
+
+namespace trace_sink {
+    Internal::Telemetry::Decoder<4 + Configuration::trace_length * sizeof(Internal::trace_record_t)> decoder;
+    uint8_t frames;
+
+    void setup() {
+        decoder.setup();
+        frames = 0;
+    }
+
+    void put(const uint8_t data) {
+        frames += decoder.receive(data);
+    }
+}
+
+void test_Trace_Replay() {
+    using namespace Internal;
+    typedef DCF77_Clock_Controller<Configuration, DCF77_No_Frequency_Control> Clock_Controller_t;
+    sample_generator generator;
+
+    // record the trace of the first minutes, it includes the sync
+    Clock_Controller_t::setup();
+    generator.setup();
+    run_clock<Clock_Controller_t>(generator, 560000);
+    assert(F("replay: synced"), Clock_Controller_t::get_clock_state() == Clock::synced,
+           Clock_Controller_t::get_clock_state());
+
+    static trace_record_t records[Configuration::trace_length];
+    const uint16_t count = Clock_Controller_t::Trace.written;
+    memcpy(records, Clock_Controller_t::Trace.records, count * sizeof(trace_record_t));
+
+    // the trace is dumped as telemetry
+    trace_sink::setup();
+    Clock_Controller_t::Trace.send_telemetry(trace_sink::put);
+    Telemetry::Reader reader;
+    reader.setup(trace_sink::decoder.payload, trace_sink::decoder.payload_length);
+    const uint32_t written = reader.get_32();
+    assert(F("trace telemetry"),
+           trace_sink::frames == 1 && trace_sink::decoder.frame_type == Telemetry::trace_frame &&
+           written == count && reader.length == 4 + count * sizeof(trace_record_t) &&
+           !memcmp(reader.data + reader.position, records, count * sizeof(trace_record_t)),
+           trace_sink::frames, written, reader.length);
+
+    const uint16_t replayed = Clock_Controller_t::replay_trace(records, count);
+    assert(F("replay reproduces the trace"), count == 560 && replayed == count, count, replayed);
+
+    // the host replays the received telemetry
+    static trace_record_t received[Configuration::trace_length];
+    memcpy(received, reader.data + reader.position, count * sizeof(trace_record_t));
+    const uint16_t replayed_telemetry = Clock_Controller_t::replay_trace(received, count);
+    assert(F("replay of the trace telemetry"), replayed_telemetry == count, replayed_telemetry);
+}
+
+// seeds the date decoders with year 2017, the given month
+// and the given weekday, the days are seeded by the caller
+template <typename Clock_Controller>
+void seed_date(const uint8_t month, const uint8_t weekday, const uint8_t weekday_weight) {
+    Clock_Controller::setup();
+    BCD::bcd_t value;
+    value.val = month;
+    Clock_Controller::Month_Decoder.seed(value, 20);
+    value.val = 7;
+    Clock_Controller::Year_Decoder.seed(value, 20);
+    value.val = 1;
+    Clock_Controller::Year_Decoder.Decade_Decoder.seed(value, 20);
+    value.val = weekday;
+    Clock_Controller::Weekday_Decoder.seed(value, weekday_weight);
+}
+
+template <typename Clock_Controller>
+void seed_day(const uint8_t day, const uint8_t weight) {
+    BCD::bcd_t value;
+    value.val = day;
+    Clock_Controller::Day_Decoder.seed(value, weight);
+}
+
+void test_Joint_Date() {
+    using namespace Internal;
+    typedef DCF77_Clock_Controller<Configuration, DCF77_No_Frequency_Control> Clock_Controller_t;
+
+    {
+        // Sunday 2017-05-21, clear evidence
+        seed_date<Clock_Controller_t>(0x05, 7, 20);
+        seed_day<Clock_Controller_t>(0x21, 20);
+        Clock_Controller_t::update_joint_date_quality_factor();
+        assert(F("joint date: clear date"), Clock_Controller_t::joint_date_quality_factor > 0,
+               Clock_Controller_t::joint_date_quality_factor);
+    }
+
+    {
+        // the weekday decides between the 21st and the 22nd,
+        // the joint stage is more confident than the day decoder
+        seed_date<Clock_Controller_t>(0x05, 7, 30);
+        seed_day<Clock_Controller_t>(0x21, 20);
+        seed_day<Clock_Controller_t>(0x22, 18);
+        Clock_Controller_t::update_joint_date_quality_factor();
+        assert(F("joint date: weekday resolves the day"),
+               Clock_Controller_t::joint_date_quality_factor > Clock_Controller_t::Day_Decoder.get_quality_factor(),
+               Clock_Controller_t::joint_date_quality_factor, Clock_Controller_t::Day_Decoder.get_quality_factor());
+    }
+
+    {
+        // the 28th has the same weekday as the 21st, the margin over
+        // it is small even though the 22nd is the runner up bin
+        seed_date<Clock_Controller_t>(0x05, 7, 20);
+        seed_day<Clock_Controller_t>(0x21, 20);
+        seed_day<Clock_Controller_t>(0x22, 18);
+        seed_day<Clock_Controller_t>(0x28, 17);
+        Clock_Controller_t::update_joint_date_quality_factor();
+        assert(F("joint date: same weekday a week later"), Clock_Controller_t::joint_date_quality_factor == 0,
+               Clock_Controller_t::joint_date_quality_factor);
+    }
+
+    {
+        // Sunday 2017-04-30, the 31st does not exist but the 23rd is a Sunday as well
+        seed_date<Clock_Controller_t>(0x04, 7, 20);
+        seed_day<Clock_Controller_t>(0x30, 20);
+        seed_day<Clock_Controller_t>(0x31, 18);
+        seed_day<Clock_Controller_t>(0x23, 17);
+        Clock_Controller_t::update_joint_date_quality_factor();
+        assert(F("joint date: invalid runner up"), Clock_Controller_t::joint_date_quality_factor == 0,
+               Clock_Controller_t::joint_date_quality_factor);
+    }
+
+    {
+        // the joint stage does not speak for a date the weekday contradicts
+        seed_date<Clock_Controller_t>(0x05, 1, 20);
+        seed_day<Clock_Controller_t>(0x21, 20);
+        Clock_Controller_t::update_joint_date_quality_factor();
+        assert(F("joint date: contradicting weekday"), Clock_Controller_t::joint_date_quality_factor == 0,
+               Clock_Controller_t::joint_date_quality_factor);
+    }
+
+    Clock_Controller_t::setup();
+}
+
+namespace monitor_sink {
+    uint8_t samples;
+    uint8_t last_sample;
+    Clock::clock_state_t old_state;
+    Clock::clock_state_t new_state;
+
+    void setup() {
+        samples = 0;
+        last_sample = 0;
+        old_state = Clock::useless;
+        new_state = Clock::useless;
+    }
+
+    void on_sample(const uint8_t sampled_data) {
+        last_sample = sampled_data;
+        ++samples;
+    }
+
+    void on_clock_state_change(const Clock::clock_state_t old_clock_state, const Clock::clock_state_t new_clock_state) {
+        old_state = old_clock_state;
+        new_state = new_clock_state;
+    }
+}
+
+void test_Callback_Monitor() {
+    using namespace Internal;
+
+    monitor_sink::setup();
+    DCF77_Callback_Monitor::on_sample(1);
+    DCF77_Callback_Monitor::on_clock_state_change(Clock::useless, Clock::dirty);
+    DCF77_Callback_Monitor::on_tick_decision(DCF77::long_tick);
+    assert(F("callback monitor: hooks without handler do nothing"), monitor_sink::samples == 0,
+           monitor_sink::samples);
+
+    DCF77_Callback_Monitor::set_sample_handler(monitor_sink::on_sample);
+    DCF77_Callback_Monitor::set_clock_state_change_handler(monitor_sink::on_clock_state_change);
+    DCF77_Callback_Monitor::on_sample(1);
+    DCF77_Callback_Monitor::on_sample(0);
+    DCF77_Callback_Monitor::on_clock_state_change(Clock::locked, Clock::unlocked);
+    assert(F("callback monitor: samples are forwarded"),
+           monitor_sink::samples == 2 && monitor_sink::last_sample == 0,
+           monitor_sink::samples, monitor_sink::last_sample);
+    assert(F("callback monitor: state changes are forwarded"),
+           monitor_sink::old_state == Clock::locked && monitor_sink::new_state == Clock::unlocked,
+           monitor_sink::old_state, monitor_sink::new_state);
+
+    DCF77_Callback_Monitor::set_sample_handler(0);
+    DCF77_Callback_Monitor::set_clock_state_change_handler(0);
+    DCF77_Callback_Monitor::on_sample(1);
+    assert(F("callback monitor: handlers can be removed"), monitor_sink::samples == 2,
+           monitor_sink::samples);
+}
+
+namespace deferred_output_sink {
+    Clock::time_t time;
+    uint16_t latency_ms;
+    uint8_t calls;
+
+    void setup() {
+        calls = 0;
+    }
+
+    void handler(const Clock::time_t &decoded_time, const uint16_t latency) {
+        time = decoded_time;
+        latency_ms = latency;
+        ++calls;
+    }
+}
+
+void test_Deferred_Output() {
+    using namespace Internal;
+    // the controller behind DCF77_Clock
+    typedef DCF77_Clock_Controller<Configuration, DCF77_Frequency_Control, DCF77_Clock_Monitor> Clock_Controller_t;
+
+    DCF77_Encoder now;
+    now.reset();
+    now.minute.val = 0x42;
+    now.hour.val = 0x13;
+    now.second = 10;
+
+    Clock_Controller_t::setup();
+    deferred_output_sink::setup();
+    DCF77_Clock::set_deferred_output_handler(deferred_output_sink::handler);
+    assert(F("deferred output: nothing pending"), !DCF77_Clock::dispatch_output());
+
+    {
+        // the 1 Hz path only publishes
+        Clock_Controller_t::Local_Clock.tick = 0;
+        Clock_Controller_t::local_clock_flush(now);
+        assert(F("deferred output: publish does not call the handler"),
+               deferred_output_sink::calls == 0, deferred_output_sink::calls);
+
+        // the main loop dispatches 25 ms later
+        Clock_Controller_t::Local_Clock.tick = 25;
+        const bool dispatched = DCF77_Clock::dispatch_output();
+        assert(F("deferred output: dispatch calls the handler"),
+               dispatched && deferred_output_sink::calls == 1 &&
+               deferred_output_sink::time.second.val == 0x10 &&
+               deferred_output_sink::time.minute.val == 0x42 &&
+               deferred_output_sink::time.hour.val == 0x13,
+               deferred_output_sink::calls, deferred_output_sink::time.second.val);
+        assert(F("deferred output: latency"), deferred_output_sink::latency_ms == 25,
+               deferred_output_sink::latency_ms);
+        assert(F("deferred output: dispatched once"),
+               !DCF77_Clock::dispatch_output() && deferred_output_sink::calls == 1,
+               deferred_output_sink::calls);
+    }
+
+    {
+        // a slow main loop gets the latest second only
+        Clock_Controller_t::Local_Clock.tick = 0;
+        now.advance_second();
+        Clock_Controller_t::local_clock_flush(now);
+        now.advance_second();
+        Clock_Controller_t::local_clock_flush(now);
+        const bool dispatched = DCF77_Clock::dispatch_output();
+        assert(F("deferred output: overwritten mailbox"),
+               dispatched && deferred_output_sink::calls == 2 &&
+               deferred_output_sink::time.second.val == 0x12,
+               deferred_output_sink::calls, deferred_output_sink::time.second.val);
+        assert(F("deferred output: overwritten mailbox dispatched once"),
+               !DCF77_Clock::dispatch_output() && deferred_output_sink::calls == 2,
+               deferred_output_sink::calls);
+    }
+
+    {
+        // replacing the handler drops a pending second
+        now.advance_second();
+        Clock_Controller_t::local_clock_flush(now);
+        DCF77_Clock::set_deferred_output_handler(deferred_output_sink::handler);
+        assert(F("deferred output: new handler drops pending"),
+               !DCF77_Clock::dispatch_output() && deferred_output_sink::calls == 2,
+               deferred_output_sink::calls);
+    }
+
+    {
+        // seconds published by the running clock
+        sample_generator generator;
+        generator.setup();
+        run_clock<Clock_Controller_t>(generator, 200000 + 300);
+        const bool dispatched = DCF77_Clock::dispatch_output();
+        const DCF77_Encoder &local_time = Clock_Controller_t::Local_Clock.local_clock_time;
+        assert(F("deferred output: running clock"),
+               dispatched &&
+               deferred_output_sink::time.second.val == BCD::int_to_bcd(local_time.second).val &&
+               deferred_output_sink::time.minute.val == local_time.minute.val &&
+               deferred_output_sink::latency_ms == Clock_Controller_t::Local_Clock.tick,
+               deferred_output_sink::time.second.val, deferred_output_sink::latency_ms);
+    }
+
+    DCF77_Clock::set_deferred_output_handler(0);
+}
+
+// checksum over the state of the clock controller
+template <typename Clock_Controller>
+uint16_t controller_checksum() {
+    using namespace Internal;
+    uint8_t sum_1 = 0;
+    uint8_t sum_2 = 0;
+    const struct { const void *data; uint16_t size; } parts[] = {
+        { &Clock_Controller::Demodulator,    sizeof(Clock_Controller::Demodulator) },
+        { &Clock_Controller::Local_Clock,    sizeof(Clock_Controller::Local_Clock) },
+        { &Clock_Controller::Second_Decoder, sizeof(Clock_Controller::Second_Decoder) },
+        { &Clock_Controller::Minute_Decoder, sizeof(Clock_Controller::Minute_Decoder) },
+        { &Clock_Controller::Hour_Decoder,   sizeof(Clock_Controller::Hour_Decoder) },
+        { (const void *)&DCF77_Frequency_Control::deviation_tracker, sizeof(DCF77_Frequency_Control::deviation_tracker) }
+    };
+    for (uint8_t part = 0; part < sizeof(parts)/sizeof(parts[0]); ++part) {
+        const uint8_t *data = (const uint8_t *)parts[part].data;
+        for (uint16_t index = 0; index < parts[part].size; ++index) {
+            Telemetry::checksum_add(sum_1, sum_2, data[index]);
+        }
+    }
+    return ((uint16_t)sum_2 << 8) | sum_1;
+}
+
+void test_process_samples() {
+    using namespace Internal;
+    typedef DCF77_Clock_Controller<Configuration, DCF77_Frequency_Control, DCF77_Clock_Monitor> Clock_Controller_t;
+
+    const uint32_t samples = 200000;
+    const uint16_t words_per_block = 32;
+    sample_generator generator;
+
+    // setup() resets neither the calibration of the frequency control
+    // nor the second toggle of the local clock, thus both runs start
+    // from a copy
+    uint8_t tracker[sizeof(DCF77_Frequency_Control::deviation_tracker)];
+    memcpy(tracker, (const void *)&DCF77_Frequency_Control::deviation_tracker, sizeof(tracker));
+    const DCF77_Frequency_Control::calibration_state_t calibration_state = DCF77_Frequency_Control::get_calibration_state();
+    const int16_t deviation = DCF77_Frequency_Control::deviation;
+    uint8_t local_clock[sizeof(Clock_Controller_t::Local_Clock)];
+    memcpy(local_clock, (const void *)&Clock_Controller_t::Local_Clock, sizeof(local_clock));
+
+    Clock_Controller_t::setup();
+    generator.setup();
+    for (uint32_t sample = 0; sample < samples; ++sample) {
+        Clock_Controller_t::process_1_kHz_tick_data(generator.next());
+    }
+    const uint16_t per_sample_checksum = controller_checksum<Clock_Controller_t>();
+    const Clock::clock_state_t per_sample_state = Clock_Controller_t::get_clock_state();
+
+    memcpy((void *)&DCF77_Frequency_Control::deviation_tracker, tracker, sizeof(tracker));
+    DCF77_Frequency_Control::calibration_state.qualified = calibration_state.qualified;
+    DCF77_Frequency_Control::calibration_state.running = calibration_state.running;
+    DCF77_Frequency_Control::deviation = deviation;
+    memcpy((void *)&Clock_Controller_t::Local_Clock, local_clock, sizeof(local_clock));
+    Clock_Controller_t::setup();
+    generator.setup();
+    for (uint32_t sample = 0; sample < samples; sample += 32 * words_per_block) {
+        uint32_t packed[words_per_block];
+        const uint16_t block = samples - sample < 32 * words_per_block? samples - sample: 32 * words_per_block;
+        memset(packed, 0, sizeof(packed));
+        for (uint16_t index = 0; index < block; ++index) {
+            packed[index >> 5] |= (uint32_t)generator.next() << (index & 31);
+        }
+        Clock_Controller_t::process_samples(packed, block);
+    }
+    const uint16_t bulk_checksum = controller_checksum<Clock_Controller_t>();
+    const Clock::clock_state_t bulk_state = Clock_Controller_t::get_clock_state();
+
+    assert(F("signal locked"), per_sample_state >= Clock::locked, per_sample_state);
+    assert(F("process_samples matches the per sample path"),
+           per_sample_checksum == bulk_checksum && per_sample_state == bulk_state,
+           per_sample_checksum, bulk_checksum);
+}
+
+void test_Snapshot() {
+    using namespace Internal;
+    typedef DCF77_Clock_Controller<Configuration, DCF77_No_Frequency_Control> Clock_Controller_t;
+    sample_generator generator;
+
+    Clock_Controller_t::setup();
+    generator.setup();
+    run_clock<Clock_Controller_t>(generator, 200000);
+    assert(F("snapshot: synced"), Clock_Controller_t::get_clock_state() == Clock::synced,
+           Clock_Controller_t::get_clock_state());
+
+    Clock_Controller_t::snapshot_t snapshot;
+    Clock_Controller_t::save_snapshot(snapshot);
+    const uint8_t minute_quality = Clock_Controller_t::Minute_Decoder.get_quality_factor();
+
+    {
+        // restart 10 minutes later, the decoders are realigned by the age
+        const uint32_t age_seconds = 600;
+        Clock_Controller_t::setup();
+        for (uint32_t ms = 0; ms < age_seconds * 1000; ++ms) {
+            generator.next();
+        }
+        DCF77_Encoder expected_time = snapshot.decoder_time;
+        for (uint8_t minute = 0; minute < age_seconds / 60; ++minute) {
+            expected_time.advance_minute();
+        }
+        const bool restored = Clock_Controller_t::restore_snapshot(snapshot, age_seconds);
+        assert(F("snapshot: restored"),
+               restored &&
+               Clock_Controller_t::restore_state == Clock_Controller_t::restore_waiting &&
+               Clock_Controller_t::Minute_Decoder.get_time_value().val == expected_time.minute.val &&
+               Clock_Controller_t::Hour_Decoder.get_time_value().val == expected_time.hour.val &&
+               Clock_Controller_t::Day_Decoder.get_time_value().val == expected_time.day.val &&
+               Clock_Controller_t::Minute_Decoder.get_quality_factor() == minute_quality,
+               restored, Clock_Controller_t::Minute_Decoder.get_time_value().val, expected_time.minute.val,
+               Clock_Controller_t::Minute_Decoder.get_quality_factor(), minute_quality);
+
+        // once the second decoder has the phase of the minute the clock syncs again
+        run_clock<Clock_Controller_t>(generator, 200000);
+        DCF77_Encoder local_time = Clock_Controller_t::Local_Clock.local_clock_time;
+        local_time.advance_minute();
+        assert(F("snapshot: synced after restore"),
+               Clock_Controller_t::get_clock_state() == Clock::synced &&
+               Clock_Controller_t::restore_state == Clock_Controller_t::restore_idle &&
+               local_time.minute.val == generator.encoder.minute.val &&
+               local_time.hour.val == generator.encoder.hour.val &&
+               local_time.second == generator.encoder.second,
+               Clock_Controller_t::get_clock_state(), Clock_Controller_t::restore_state,
+               local_time.minute.val, generator.encoder.minute.val);
+    }
+
+    {
+        // rejected snapshots leave the decoders alone
+        Clock_Controller_t::setup();
+        const uint16_t checksum = controller_checksum<Clock_Controller_t>();
+
+        assert(F("snapshot: too old"),
+               !Clock_Controller_t::restore_snapshot(snapshot, Configuration::max_snapshot_age + 1));
+
+        Clock_Controller_t::snapshot_t corrupted = snapshot;
+        ((uint8_t *)&corrupted.minute)[1] ^= 0x01;
+        assert(F("snapshot: checksum"), !Clock_Controller_t::restore_snapshot(corrupted, 0));
+
+        Clock_Controller_t::snapshot_t outdated = snapshot;
+        ++outdated.version;
+        outdated.checksum = Clock_Controller_t::get_snapshot_checksum(outdated);
+        assert(F("snapshot: version"), !Clock_Controller_t::restore_snapshot(outdated, 0));
+
+        Clock_Controller_t::snapshot_t unsynced;
+        Clock_Controller_t::save_snapshot(unsynced);
+        assert(F("snapshot: not synced"),
+               unsynced.clock_state == Clock::useless && !Clock_Controller_t::restore_snapshot(unsynced, 0),
+               unsynced.clock_state);
+
+        assert(F("snapshot: rejection keeps the state"),
+               controller_checksum<Clock_Controller_t>() == checksum &&
+               Clock_Controller_t::restore_state == Clock_Controller_t::restore_idle,
+               controller_checksum<Clock_Controller_t>(), checksum);
+    }
+
+    Clock_Controller_t::setup();
+}
+
+void test_Telemetry() {
+    using namespace Internal;
+
+    {  // zigzag
+        assert(F("zigzag 0"), Telemetry::zigzag(0) == 0, Telemetry::zigzag(0));
+        assert(F("zigzag -1"), Telemetry::zigzag(-1) == 1, Telemetry::zigzag(-1));
+        assert(F("zigzag 1"), Telemetry::zigzag(1) == 2, Telemetry::zigzag(1));
+        for (int32_t value = -300; value <= 300; ++value) {
+            assert(F("unzigzag inverts zigzag"), Telemetry::unzigzag(Telemetry::zigzag(value)) == value, value);
+        }
+    }
+
+    {  // varint length
+        assert(F("varint 127"), Telemetry::varint_length(127) == 1, Telemetry::varint_length(127));
+        assert(F("varint 128"), Telemetry::varint_length(128) == 2, Telemetry::varint_length(128));
+        assert(F("varint max"), Telemetry::varint_length(0xffffffff) == 5, Telemetry::varint_length(0xffffffff));
+    }
+
+    {  // frames
+        telemetry_sink::length = 0;
+        Telemetry::Encoder encoder;
+        encoder.begin(telemetry_sink::put, Telemetry::statistics_frame, 1 + 2 + 4 + 3);
+        encoder.put(0x12);
+        encoder.put_16(0x3456);
+        encoder.put_32(0x789abcde);
+        encoder.put_varint(20000);
+        encoder.end();
+        const uint8_t frame_length = telemetry_sink::length;
+        assert(F("frame length"), frame_length == 1 + 1 + 2 + 10 + 2, frame_length);
+        assert(F("frame start"), telemetry_sink::buffer[0] == Telemetry::start_byte, telemetry_sink::buffer[0]);
+
+        Telemetry::Decoder<16> decoder;
+        decoder.setup();
+        uint8_t frames = 0;
+        for (uint8_t index = 0; index < frame_length; ++index) {
+            frames += decoder.receive(telemetry_sink::buffer[index]);
+        }
+        assert(F("frame received"), frames == 1 && decoder.frame_type == Telemetry::statistics_frame,
+               frames, decoder.frame_type);
+
+        Telemetry::Reader reader;
+        reader.setup(decoder.payload, decoder.payload_length);
+        assert(F("read 8 bit"),  reader.get()        == 0x12,       reader.position);
+        assert(F("read 16 bit"), reader.get_16()     == 0x3456,     reader.position);
+        assert(F("read 32 bit"), reader.get_32()     == 0x789abcde, reader.position);
+        assert(F("read varint"), reader.get_varint() == 20000,      reader.position);
+        assert(F("payload consumed"), reader.ok && reader.position == reader.length, reader.position);
+        reader.get();
+        assert(F("read beyond payload"), !reader.ok, reader.position);
+
+        // a corrupted frame is dropped, the next frame is received again
+        telemetry_sink::buffer[5] ^= 0x01;
+        frames = 0;
+        for (uint8_t index = 0; index < frame_length; ++index) {
+            frames += decoder.receive(telemetry_sink::buffer[index]);
+        }
+        assert(F("corrupted frame dropped"), frames == 0 && decoder.dropped_frames == 1,
+               frames, decoder.dropped_frames);
+
+        telemetry_sink::buffer[5] ^= 0x01;
+        for (uint8_t index = 0; index < frame_length; ++index) {
+            frames += decoder.receive(telemetry_sink::buffer[index]);
+        }
+        assert(F("resync after corrupted frame"), frames == 1, frames);
+    }
+
+    {  // phase bins are streamed in chunks
+        typedef DCF77_Demodulator<Controller_T<Configuration_T<true> > > Demodulator_t;
+        Demodulator_t demodulator;
+        demodulator.setup();
+        for (uint16_t bin = 0; bin < Demodulator_t::bin_count; ++bin) {
+            demodulator.data[bin] = (bin * 37) % 1000;
+        }
+
+        phase_bins_sink::setup();
+        demodulator.send_telemetry(phase_bins_sink::put);
+        assert(F("one phase bins frame per chunk"),
+               phase_bins_sink::frames == (Demodulator_t::bin_count + Demodulator_t::telemetry_chunk - 1) / Demodulator_t::telemetry_chunk &&
+               phase_bins_sink::decoder.dropped_frames == 0,
+               phase_bins_sink::frames, phase_bins_sink::decoder.dropped_frames);
+        assert(F("phase bins reassembled"),
+               phase_bins_sink::ok && phase_bins_sink::bin_count == Demodulator_t::bin_count &&
+               phase_bins_sink::received_bins == Demodulator_t::bin_count &&
+               memcmp(phase_bins_sink::bins, demodulator.data, sizeof(demodulator.data)) == 0,
+               phase_bins_sink::received_bins);
+    }
+}
+
+struct drain_target {
+    uint8_t space;
+    uint8_t received;
+    uint8_t last = 0;
+
+    int availableForWrite() { return space; }
+    size_t write(const uint8_t data) {
+        ++received;
+        last = data;
+        return 1;
+    }
+};
+
+void test_Buffered_Output() {
+    using namespace Internal;
+
+    Debug::Buffered_Output<8> output;
+    for (uint8_t data = 1; data <= 10; ++data) {
+        output.write(data);
+    }
+    assert(F("buffer overflow dropped and counted"), output.get_dropped() == 3, output.get_dropped());
+
+    drain_target target;
+    target.space = 4;
+    target.received = 0;
+    assert(F("drain limited by target space"), output.drain(target) == 4 && target.received == 4 && target.last == 4,
+           target.received, target.last);
+
+    target.space = 64;
+    assert(F("drain remaining data"), output.drain(target) == 3 && target.received == 7 && target.last == 7,
+           target.received, target.last);
+    assert(F("drain empty buffer"), output.drain(target) == 0, target.received);
+
+    output.print(F("ok"));
+    assert(F("print into buffer"), output.drain(target) == 2 && target.last == 'k', target.last);
+}
+
 void boilerplate() {
     Serial.println();
     Serial.print(F("Test compiled: "));
@@ -6859,12 +8476,30 @@ void setup() {
     test_Binning();
 
     test_Minute_Decoder();
+    test_Sequence_Decoder();
     test_Hour_Decoder();
     test_Day_Decoder();
     test_Month_Decoder();
     test_Year_Decoder();
     test_Decade_Decoder();
     test_Weekday_Decoder();
+    test_Frame_Decoder();
+    test_Tick_History();
+
+    test_Telemetry();
+    test_Buffered_Output();
+    test_Deviation_Tracker();
+    test_process_samples();
+    test_Phase_Events();
+    test_Diagnostics();
+    test_Statistics();
+    test_Time_Hint();
+    test_Rebinning();
+    test_Trace_Replay();
+    test_Joint_Date();
+    test_Callback_Monitor();
+    test_Deferred_Output();
+    test_Snapshot();
 
     todo(); //test_Local_Clock()
     todo(); //test_Frequency_Control()